@@ -1,34 +1,59 @@
 #version 450
 
+struct TileAppearance {
+    vec2 samplePosition;
+    vec2 sampleExtent;
+    vec2 offset;
+    vec2 repeat;
+    vec4 colourFactor;
+};
+
 layout(set = 0, binding = 0) uniform Camera {
     mat4 projection;
     mat4 view;
 }
 camera;
 
+layout(set = 0, binding = 3) uniform Palette {
+    TileAppearance entries[320];
+}
+palette;
+
 layout(location = 0) in vec2 vertexPosition;
 
-layout(location = 1) in vec2 instancePosition;
-layout(location = 2) in vec2 instanceScale;
+layout(location = 1) in ivec3 instancePosition;
+layout(location = 2) in uint instanceScale;
 
-layout(location = 3) in vec2 instanceTexturePosition;
-layout(location = 4) in vec2 instanceTextureExtent;
-layout(location = 5) in vec2 instanceTextureOffset;
-layout(location = 6) in vec2 instanceTextureRepeat;
-layout(location = 7) in vec4 instanceColourFactor;
+layout(location = 3) in uint instancePaletteIndex;
 
 layout(location = 0) out vec2 outLocalPosition;
 layout(location = 1) out vec2 outTexturePosition;
 layout(location = 2) out vec2 outTextureExtent;
 layout(location = 3) out vec4 outColourFactor;
 
+const vec2 isometricAxisX = vec2(0.894427191, 0.447213595);
+const vec2 isometricAxisY = vec2(0.0, 1.0);
+const vec2 isometricAxisZ = vec2(-0.894427191, 0.447213595);
+const vec3 isometricUnitScale = vec3(0.558, 0.5, 0.558);
+
+const float tileSubdivisions = 256.0;
+
+vec2 worldToScreenSpace(vec3 position) {
+    return isometricAxisX * position.x * isometricUnitScale.x + isometricAxisY * position.y * isometricUnitScale.y + isometricAxisZ * position.z * isometricUnitScale.z;
+}
+
 void main() {
-    vec4 transformedPosition = vec4(vertexPosition + instancePosition * instanceScale, -0.5, 1.0);
+    TileAppearance appearance = palette.entries[instancePaletteIndex];
+
+    vec2 screenPosition = worldToScreenSpace(vec3(instancePosition) / tileSubdivisions);
+    vec2 scale = vec2(instanceScale & 0xFFFFu, instanceScale >> 16) / tileSubdivisions;
+
+    vec4 transformedPosition = vec4(vertexPosition + screenPosition * scale, -0.5, 1.0);
     vec2 textureSamplePosition = vec2(vertexPosition.x, -vertexPosition.y);
 
     gl_Position = camera.projection * camera.view * transformedPosition;
-    outLocalPosition = textureSamplePosition * instanceTextureRepeat + instanceTextureOffset;
-    outTexturePosition = instanceTexturePosition;
-    outTextureExtent = instanceTextureExtent;
-    outColourFactor = instanceColourFactor;
+    outLocalPosition = textureSamplePosition * appearance.repeat + appearance.offset;
+    outTexturePosition = appearance.samplePosition;
+    outTextureExtent = appearance.sampleExtent;
+    outColourFactor = appearance.colourFactor;
 }
@@ -0,0 +1,233 @@
+#include <engine/chunk_occupation_map.hpp>
+#include <engine/paletted_voxels.hpp>
+#include <engine/world_noise.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    template <typename F>
+    double measure(std::size_t iterations, F&& function) {
+        double total = 0.0;
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+
+            function();
+
+            total += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+
+        return total / static_cast<double>(iterations);
+    }
+
+    // The previous layout, one vector per (x, y) column
+    struct NestedOccupationMap {
+        NestedOccupationMap(glm::uvec3 dimensions, const glm::ivec3& pos) {
+            entries.resize(dimensions.x, std::vector<std::vector<std::uint8_t>>(dimensions.y, std::vector<std::uint8_t>(dimensions.z, 0)));
+            position = pos;
+        }
+
+        std::vector<std::vector<std::vector<std::uint8_t>>> entries;
+
+        glm::ivec3 position;
+    };
+
+    void fillNested(NestedOccupationMap& occupationMap, glm::ivec3 extent, const std::vector<std::int32_t>& solid, const std::vector<std::int32_t>& surface) {
+        for (std::int32_t x = 0; x < extent.x; x++) {
+            for (std::int32_t z = 0; z < extent.z; z++) {
+                const std::size_t column = static_cast<std::size_t>(z) * extent.x + x;
+
+                for (std::int32_t y = 0; y < extent.y; y++) {
+                    const std::int32_t worldY = y + occupationMap.position.y;
+
+                    if (worldY < solid[column]) {
+                        occupationMap.entries[x][y][z] = 2;
+                    }
+                    else if (worldY < surface[column]) {
+                        occupationMap.entries[x][y][z] = 1;
+                    }
+                    else {
+                        occupationMap.entries[x][y][z] = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    // Walks the chunk the way generateChunk does, layer by layer along diagonals
+    template <typename Lookup>
+    std::size_t visit(glm::ivec3 extent, Lookup&& lookup) {
+        std::size_t visible = 0;
+
+        for (std::int32_t y = 0; y < extent.y; y++) {
+            for (std::int32_t diagonal = extent.x + extent.z - 2; diagonal >= 0; diagonal--) {
+                const std::int32_t firstX = std::max(0, diagonal - extent.z + 1);
+                const std::int32_t lastX = std::min(extent.x - 1, diagonal);
+
+                for (std::int32_t x = firstX; x <= lastX; x++) {
+                    visible += lookup(x, y, diagonal - x) != 0;
+                }
+            }
+        }
+
+        return visible;
+    }
+
+    // Thresholds for a chunk column the way computeChunkHeightmap derives them, for a
+    // world generated at the engine's default size
+    void sampleColumn(const engine::WorldNoiseSystem& noiseSystem, glm::ivec2 column, glm::ivec3 extent, float scale, std::vector<std::int32_t>& solid, std::vector<std::int32_t>& surface) {
+        const std::size_t layerSize = static_cast<std::size_t>(extent.x) * extent.z;
+
+        std::vector<float> sampleX(layerSize);
+        std::vector<float> sampleZ(layerSize);
+        std::vector<float> noise(layerSize);
+
+        for (std::int32_t z = 0; z < extent.z; z++) {
+            for (std::int32_t x = 0; x < extent.x; x++) {
+                sampleX[static_cast<std::size_t>(z) * extent.x + x] = static_cast<float>(column.x + x) * 0.02f;
+                sampleZ[static_cast<std::size_t>(z) * extent.x + x] = static_cast<float>(column.y + z) * 0.02f;
+            }
+        }
+
+        noiseSystem.sample(sampleX, sampleZ, noise);
+
+        solid.resize(layerSize);
+        surface.resize(layerSize);
+
+        for (std::size_t i = 0; i < layerSize; i++) {
+            const float height = scale * ((noise[i] * 0.5f) + 0.5f);
+
+            solid[i] = static_cast<std::int32_t>(height - 1);
+            surface[i] = static_cast<std::int32_t>(height);
+        }
+    }
+
+    void measureResidentMemory() {
+        const glm::ivec3 worldSize = {32, 2, 32};
+        const glm::ivec3 extent = {8, 8, 8};
+        const float scale = static_cast<float>(worldSize.y + extent.y);
+
+        engine::WorldNoiseSystem noiseSystem;
+
+        std::vector<std::int32_t> solid;
+        std::vector<std::int32_t> surface;
+
+        std::size_t chunks = 0;
+        std::size_t uniformChunks = 0;
+        std::size_t flatBytes = 0;
+        std::size_t packedBytes = 0;
+
+        for (std::int32_t x = -worldSize.x; x < worldSize.x; x++) {
+            for (std::int32_t z = -worldSize.z; z < worldSize.z; z++) {
+                sampleColumn(noiseSystem, {x * extent.x, z * extent.z}, extent, scale, solid, surface);
+
+                for (std::int32_t y = -worldSize.y; y < worldSize.y; y++) {
+                    engine::ChunkOccupationMap occupationMap(extent, {x * extent.x, y * extent.y, z * extent.z});
+                    engine::PackedOccupation packed;
+
+                    engine::fillOccupationLayers(occupationMap, solid, surface);
+                    engine::packOccupation(occupationMap, packed);
+
+                    chunks++;
+                    uniformChunks += packed.entries.isUniform();
+
+                    flatBytes += sizeof(engine::ChunkOccupationMap) + occupationMap.entries.capacity() + occupationMap.aboveLayer.capacity() + occupationMap.edgeX.capacity() + occupationMap.edgeZ.capacity();
+                    packedBytes += sizeof(engine::PackedOccupation) + packed.getMemoryUsage();
+                }
+            }
+        }
+
+        std::println("");
+        std::println("resident occupation at world size {}x{}x{}, {} chunks ({} uniform)", worldSize.x, worldSize.y, worldSize.z, chunks, uniformChunks);
+        std::println("{:>12} {:>12} {:>12}", "flat (KiB)", "packed (KiB)", "ratio");
+        std::println("{:>12} {:>12} {:>12.2f}", flatBytes / 1024, packedBytes / 1024, static_cast<double>(flatBytes) / static_cast<double>(packedBytes));
+    }
+}
+
+int main() {
+    constexpr std::size_t iterations = 256;
+
+    std::mt19937 random(1234);
+
+    std::println("{:>12} {:>16} {:>16} {:>16} {:>16} {:>16} {:>16}", "chunk", "nested fill", "flat fill", "nested visit", "flat visit", "packed visit", "pack");
+
+    for (glm::ivec3 extent : {glm::ivec3{8, 8, 8}, glm::ivec3{16, 16, 16}, glm::ivec3{32, 32, 32}, glm::ivec3{32, 128, 32}}) {
+        const std::size_t layerSize = static_cast<std::size_t>(extent.x) * extent.z;
+
+        std::vector<std::int32_t> solid(layerSize);
+        std::vector<std::int32_t> surface(layerSize);
+
+        std::uniform_int_distribution<std::int32_t> heights(0, extent.y);
+
+        for (std::size_t i = 0; i < layerSize; i++) {
+            surface[i] = heights(random);
+            solid[i] = surface[i] - 1;
+        }
+
+        const glm::ivec3 position = {0, 0, 0};
+
+        std::size_t sink = 0;
+
+        double nestedFill = measure(iterations, [&]() {
+            NestedOccupationMap occupationMap(extent, position);
+
+            fillNested(occupationMap, extent, solid, surface);
+
+            sink += occupationMap.entries[0][0][0];
+        });
+
+        double flatFill = measure(iterations, [&]() {
+            engine::ChunkOccupationMap occupationMap(extent, position);
+
+            engine::fillOccupationLayers(occupationMap, solid, surface);
+
+            sink += occupationMap.entries[0];
+        });
+
+        NestedOccupationMap nested(extent, position);
+        engine::ChunkOccupationMap flat(extent, position);
+
+        fillNested(nested, extent, solid, surface);
+        engine::fillOccupationLayers(flat, solid, surface);
+
+        double nestedVisit = measure(iterations, [&]() {
+            sink += visit(extent, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+                return nested.entries[x][y][z];
+            });
+        });
+
+        double flatVisit = measure(iterations, [&]() {
+            sink += visit(extent, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+                return flat.at(x, y, z);
+            });
+        });
+
+        engine::PalettedVoxels packed;
+
+        double pack = measure(iterations, [&]() {
+            packed.pack(flat.entries);
+
+            sink += packed.size();
+        });
+
+        double packedVisit = measure(iterations, [&]() {
+            sink += visit(extent, [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+                return packed.get(flat.index(x, y, z));
+            });
+        });
+
+        std::println("{:>4}x{:>3}x{:>3} {:>16.2f} {:>16.2f} {:>16.2f} {:>16.2f} {:>16.2f} {:>16.2f}", extent.x, extent.y, extent.z, nestedFill, flatFill, nestedVisit, flatVisit, packedVisit, pack);
+
+        if (sink == 0) {
+            std::println("");
+        }
+    }
+
+    measureResidentMemory();
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <engine/chunk.hpp>
+#include <engine/world_noise.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    template <typename F>
+    double measure(F&& function) {
+        auto start = Clock::now();
+
+        function();
+
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    // The same samples and thresholds computeChunkHeightmap writes, edges included
+    void sampleHeightmap(const engine::WorldNoiseSystem& noiseSystem, glm::ivec2 column, glm::ivec3 extent, float scale, engine::ChunkHeightmap& heightmap) {
+        const std::size_t layerSize = static_cast<std::size_t>(extent.x) * extent.z;
+        const std::size_t sampleCount = layerSize + extent.z + extent.x;
+
+        std::vector<float> sampleX(sampleCount);
+        std::vector<float> sampleZ(sampleCount);
+        std::vector<float> noise(sampleCount);
+
+        auto setSample = [&](std::size_t index, std::int32_t x, std::int32_t z) {
+            sampleX[index] = static_cast<float>(column.x + x) * 0.02f;
+            sampleZ[index] = static_cast<float>(column.y + z) * 0.02f;
+        };
+
+        for (std::int32_t z = 0; z < extent.z; z++) {
+            for (std::int32_t x = 0; x < extent.x; x++) {
+                setSample(static_cast<std::size_t>(z) * extent.x + x, x, z);
+            }
+        }
+
+        for (std::int32_t z = 0; z < extent.z; z++) {
+            setSample(layerSize + z, -1, z);
+        }
+
+        for (std::int32_t x = 0; x < extent.x; x++) {
+            setSample(layerSize + extent.z + x, x, -1);
+        }
+
+        noiseSystem.sample(sampleX, sampleZ, noise);
+
+        auto writeThresholds = [&](std::vector<std::int32_t>& solid, std::vector<std::int32_t>& surface, std::size_t first, std::size_t count) {
+            solid.resize(count);
+            surface.resize(count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                const float height = scale * ((noise[first + i] * 0.5f) + 0.5f);
+
+                solid[i] = static_cast<std::int32_t>(height - 1);
+                surface[i] = static_cast<std::int32_t>(height);
+            }
+        };
+
+        writeThresholds(heightmap.solid, heightmap.surface, 0, layerSize);
+        writeThresholds(heightmap.edgeSolidX, heightmap.edgeSurfaceX, layerSize, extent.z);
+        writeThresholds(heightmap.edgeSolidZ, heightmap.edgeSurfaceZ, layerSize + extent.z, extent.x);
+
+        heightmap.sampled = true;
+    }
+
+    bool isSameBuild(const engine::ChunkBuild& a, const engine::ChunkBuild& b) {
+        if (a.position != b.position || a.instances.size() != b.instances.size() || a.orders != b.orders) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.instances.size(); i++) {
+            const engine::TileInstance& first = a.instances[i];
+            const engine::TileInstance& second = b.instances[i];
+
+            if (first.transform.position != second.transform.position || first.transform.scale != second.transform.scale || first.paletteIndex != second.paletteIndex) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Every cell and column top the spans report against the occupation map
+    std::size_t countQueryMismatches(const engine::ChunkColumnSpans& columnSpans, const engine::ChunkOccupationMap& occupationMap) {
+        const glm::ivec3 extent = occupationMap.extent;
+
+        std::size_t mismatches = 0;
+
+        for (std::int32_t x = 0; x < extent.x; x++) {
+            for (std::int32_t z = 0; z < extent.z; z++) {
+                std::int32_t top = -1;
+
+                for (std::int32_t y = 0; y < extent.y; y++) {
+                    const bool occupied = occupationMap.at(x, y, z) != 0;
+
+                    if (occupied) {
+                        top = y;
+                    }
+
+                    mismatches += columnSpans.isOccupied(x, y, z) != occupied;
+                }
+
+                mismatches += columnSpans.findTopTile(x, z) != top;
+            }
+        }
+
+        return mismatches;
+    }
+}
+
+// Builds every chunk of a world through the occupation map and through column runs taken
+// from the heightmap (fresh chunks) and from the occupation map (records and revisits).
+// All three builds have to hold the same tiles in the same order, and the span queries
+// have to agree with the occupation map
+int main() {
+    constexpr glm::ivec3 worldSize = {16, 2, 16};
+
+    const std::array<engine::Tile, 3> tilesAvailable = {
+        engine::Tile{.visible = false},
+        engine::Tile{.visible = true},
+        engine::Tile{.visible = true},
+    };
+
+    engine::WorldNoiseSystem noiseSystem;
+
+    std::println("{:>12} {:>8} {:>10} {:>16} {:>16} {:>16} {:>16} {:>16} {:>10}", "chunk", "chunks", "tiles", "occupancy fill", "occupancy emit", "span fill", "span from map", "span emit", "mismatch");
+
+    for (glm::ivec3 extent : {glm::ivec3{8, 8, 8}, glm::ivec3{16, 16, 16}, glm::ivec3{32, 32, 32}}) {
+        const float scale = static_cast<float>(worldSize.y + extent.y);
+
+        engine::ChunkHeightmap heightmap;
+        engine::ChunkBuild occupationBuild;
+        engine::ChunkBuild spanBuild;
+        engine::ChunkBuild codedBuild;
+
+        std::size_t chunks = 0;
+        std::size_t tiles = 0;
+        std::size_t mismatches = 0;
+
+        double occupationFill = 0.0;
+        double occupationEmit = 0.0;
+        double spanFill = 0.0;
+        double spanCode = 0.0;
+        double spanEmit = 0.0;
+
+        for (std::int32_t x = -worldSize.x; x < worldSize.x; x++) {
+            for (std::int32_t z = -worldSize.z; z < worldSize.z; z++) {
+                sampleHeightmap(noiseSystem, {x * extent.x, z * extent.z}, extent, scale, heightmap);
+
+                for (std::int32_t y = -worldSize.y; y < worldSize.y; y++) {
+                    const glm::ivec3 position = {x * extent.x, y * extent.y, z * extent.z};
+
+                    engine::ChunkOccupationMap occupationMap(extent, position);
+                    engine::ChunkColumnSpans columnSpans(extent, position);
+                    engine::ChunkColumnSpans codedSpans(extent, position);
+
+                    occupationFill += measure([&]() {
+                        engine::determineChunkTiles(occupationMap, heightmap);
+                    });
+
+                    occupationEmit += measure([&]() {
+                        engine::generateChunk(occupationBuild, occupationMap, tilesAvailable);
+                    });
+
+                    spanFill += measure([&]() {
+                        engine::determineChunkSpans(columnSpans, heightmap);
+                    });
+
+                    spanCode += measure([&]() {
+                        engine::determineChunkSpans(codedSpans, occupationMap);
+                    });
+
+                    spanEmit += measure([&]() {
+                        engine::generateChunk(spanBuild, columnSpans, tilesAvailable);
+                    });
+
+                    engine::generateChunk(codedBuild, codedSpans, tilesAvailable);
+
+                    chunks++;
+                    tiles += occupationBuild.instances.size();
+                    mismatches += !isSameBuild(occupationBuild, spanBuild) + !isSameBuild(occupationBuild, codedBuild);
+                    mismatches += countQueryMismatches(columnSpans, occupationMap) + countQueryMismatches(codedSpans, occupationMap);
+                }
+            }
+        }
+
+        const double perChunk = 1.0 / static_cast<double>(chunks);
+
+        std::println("{:>4}x{:>3}x{:>3} {:>8} {:>10} {:>16.2f} {:>16.2f} {:>16.2f} {:>16.2f} {:>16.2f} {:>10}", extent.x, extent.y, extent.z, chunks, tiles, occupationFill * perChunk, occupationEmit * perChunk, spanFill * perChunk, spanCode * perChunk, spanEmit * perChunk, mismatches);
+    }
+}
\ No newline at end of file
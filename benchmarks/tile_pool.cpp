@@ -0,0 +1,249 @@
+#include <engine/tile_pool.hpp>
+#include <engine/worker_pool.hpp>
+
+#include <chrono>
+#include <print>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    template <typename F>
+    double measure(std::size_t iterations, F&& function) {
+        double total = 0.0;
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+
+            function();
+
+            total += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+
+        return total / static_cast<double>(iterations);
+    }
+
+    std::int64_t gridOrder(std::size_t index, std::int64_t extent) {
+        const std::int64_t x = static_cast<std::int64_t>(index) % extent;
+        const std::int64_t z = (static_cast<std::int64_t>(index) / extent) % extent;
+        const std::int64_t y = static_cast<std::int64_t>(index) / (extent * extent);
+
+        return (16 - y) * (extent * 2 - 1) + x + z;
+    }
+}
+
+int main() {
+    constexpr std::size_t iterations = 32;
+    constexpr std::size_t movingTiles = 16;
+
+    std::mt19937_64 random(1234);
+
+    std::println("{:>10} {:>14} {:>14} {:>14}", "tiles", "steady (us)", "moving (us)", "rebuild (us)");
+
+    for (std::size_t count : {1'000uz, 10'000uz, 100'000uz, 250'000uz, 500'000uz, 1'000'000uz}) {
+        engine::TilePool pool;
+
+        std::vector<components::TileProxy> proxies;
+        proxies.reserve(count);
+
+        const std::int64_t extent = 256;
+
+        for (std::size_t i = 0; i < count; i++) {
+            proxies.push_back(pool.insert({}, gridOrder(i, extent)));
+        }
+
+        pool.sortByDepth();
+
+        double steady = measure(iterations, [&]() {
+            pool.sortByDepth();
+        });
+
+        std::uniform_int_distribution<std::size_t> pick(0, count - 1);
+
+        double moving = measure(iterations, [&]() {
+            for (std::size_t i = 0; i < movingTiles; i++) {
+                pool.getData(proxies[pick(random)]).order = gridOrder(pick(random), extent);
+            }
+
+            pool.sortByDepth();
+        });
+
+        double rebuild = measure(iterations, [&]() {
+            for (auto& proxy : proxies) {
+                pool.getData(proxy).order = gridOrder(pick(random), extent);
+            }
+
+            pool.sortByDepth();
+        });
+
+        std::println("{:>10} {:>14.1f} {:>14.1f} {:>14.1f}", count, steady, moving, rebuild);
+    }
+
+    constexpr std::size_t chunkTiles = 8 * 8 * 8;
+
+    std::println("");
+    std::println("{:>10} {:>20} {:>20}", "tiles", "chunk reload (us)", "group reload (us)");
+
+    for (std::size_t count : {10'000uz, 100'000uz, 1'000'000uz}) {
+        engine::TilePool pool;
+
+        std::vector<engine::TileInstance> instances(chunkTiles);
+        std::vector<std::int64_t> orders(chunkTiles);
+        std::vector<components::TileProxy> chunk;
+
+        for (std::size_t i = 0; i < chunkTiles; i++) {
+            orders[i] = gridOrder(i, 256);
+        }
+
+        for (std::size_t i = 0; i < count; i++) {
+            pool.insert({}, gridOrder(i, 256));
+        }
+
+        for (std::size_t i = 0; i < chunkTiles; i++) {
+            chunk.push_back(pool.insert(instances[i], orders[i]));
+        }
+
+        double single = measure(iterations, [&]() {
+            for (auto& proxy : chunk) {
+                pool.remove(proxy);
+            }
+
+            for (std::size_t i = 0; i < chunkTiles; i++) {
+                chunk[i] = pool.insert(instances[i], orders[i]);
+            }
+        });
+
+        for (auto& proxy : chunk) {
+            pool.remove(proxy);
+        }
+
+        std::uint32_t group = pool.createGroup();
+
+        pool.insertBatch(instances, orders, group);
+
+        double batch = measure(iterations, [&]() {
+            pool.releaseGroup(group);
+            pool.compact();
+
+            group = pool.createGroup();
+            pool.insertBatch(instances, orders, group);
+        });
+
+        std::println("{:>10} {:>20.1f} {:>20.1f}", count, single, batch);
+    }
+
+    constexpr std::size_t scalingTiles = 1'000'000;
+
+    std::println("");
+    std::println("{:>10} {:>14} {:>14}", "threads", "rebuild (us)", "speedup");
+
+    double baseline = 0.0;
+
+    for (std::size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        engine::WorkerPool workerPool;
+        engine::TilePool pool;
+
+        workerPool.create(threads);
+        pool.setWorkerPool(&workerPool);
+
+        std::vector<components::TileProxy> proxies;
+        proxies.reserve(scalingTiles);
+
+        for (std::size_t i = 0; i < scalingTiles; i++) {
+            proxies.push_back(pool.insert({}, gridOrder(i, 256)));
+        }
+
+        std::uniform_int_distribution<std::size_t> pick(0, scalingTiles - 1);
+
+        double rebuild = 0.0;
+
+        for (std::size_t iteration = 0; iteration < iterations; iteration++) {
+            for (auto& proxy : proxies) {
+                pool.setOrder(proxy, gridOrder(pick(random), 256));
+            }
+
+            rebuild += measure(1, [&]() {
+                pool.sortByDepth();
+            });
+        }
+
+        rebuild /= static_cast<double>(iterations);
+
+        if (threads == 1) {
+            baseline = rebuild;
+        }
+
+        std::println("{:>10} {:>14.1f} {:>14.2f}", threads, rebuild, baseline / rebuild);
+    }
+
+    // Every other chunk is released with an entity tile sorted into the middle of its
+    // band. Only the chunk's own tiles may drop out of the live ranges, the entities
+    // have to stay drawn before and during compaction
+    std::println("");
+    std::println("{:>10} {:>20} {:>16} {:>16}", "chunks", "live ranges (us)", "entities drawn", "mid-compaction");
+
+    for (std::size_t chunkCount : {16uz, 256uz, 2048uz}) {
+        engine::TilePool pool;
+
+        std::vector<engine::TileInstance> instances(chunkTiles);
+        std::vector<std::int64_t> orders(chunkTiles);
+        std::vector<std::uint32_t> groups;
+
+        std::size_t entities = 0;
+
+        for (std::size_t chunk = 0; chunk < chunkCount; chunk++) {
+            const std::int64_t band = static_cast<std::int64_t>(chunk * chunkTiles * 2);
+
+            for (std::size_t i = 0; i < chunkTiles; i++) {
+                orders[i] = band + static_cast<std::int64_t>(i * 2);
+            }
+
+            groups.push_back(pool.createGroup());
+            pool.insertBatch(instances, orders, groups.back());
+
+            if (chunk % 2 == 0) {
+                engine::TileInstance entity = {
+                    .transform = {
+                        .position = {-1, static_cast<std::int32_t>(chunk), 0},
+                        .scale = engine::packTileScale({1.0f, 1.0f}),
+                    },
+                };
+
+                pool.insert(entity, band + static_cast<std::int64_t>(chunkTiles) + 1);
+                entities++;
+            }
+        }
+
+        pool.sortByDepth();
+
+        for (std::size_t chunk = 0; chunk < chunkCount; chunk += 2) {
+            pool.releaseGroup(groups[chunk]);
+        }
+
+        auto countDrawn = [&]() {
+            std::size_t drawn = 0;
+
+            for (const engine::TileRange& range : pool.getLiveRanges()) {
+                for (std::size_t i = range.begin; i < range.end; i++) {
+                    drawn += pool.transforms()[i].position.x == -1;
+                }
+            }
+
+            return drawn;
+        };
+
+        double liveRanges = measure(iterations, [&]() {
+            pool.getLiveRanges();
+        });
+
+        const std::size_t drawn = countDrawn();
+
+        pool.compact(std::chrono::microseconds(1));
+
+        const std::size_t drawnCompacting = countDrawn();
+
+        std::println("{:>10} {:>20.1f} {:>10}/{:<5} {:>10}/{:<5}", chunkCount, liveRanges, drawn, entities, drawnCompacting, entities);
+    }
+}
\ No newline at end of file
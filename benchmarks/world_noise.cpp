@@ -0,0 +1,87 @@
+#include <engine/world_noise.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <print>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/noise.hpp>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    template <typename F>
+    double measure(std::size_t iterations, F&& function) {
+        double total = 0.0;
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+
+            function();
+
+            total += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+
+        return total / static_cast<double>(iterations);
+    }
+}
+
+int main() {
+    constexpr std::size_t iterations = 64;
+
+    engine::WorldNoiseSystem noiseSystem;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> coordinates(-1000.0f, 1000.0f);
+
+    std::println("batch width {}", engine::WorldNoiseSystem::getBatchWidth());
+    std::println("{:>10} {:>14} {:>14} {:>14} {:>14} {:>12}", "samples", "glm 2D (us)", "batch 2D (us)", "glm 3D (us)", "batch 3D (us)", "max error");
+
+    for (std::size_t count : {256uz, 1'024uz, 4'096uz, 65'536uz}) {
+        std::vector<float> x(count);
+        std::vector<float> y(count);
+        std::vector<float> z(count);
+        std::vector<float> reference(count);
+        std::vector<float> result(count);
+
+        for (std::size_t i = 0; i < count; i++) {
+            x[i] = coordinates(random);
+            y[i] = coordinates(random);
+            z[i] = coordinates(random);
+        }
+
+        float maxError = 0.0f;
+
+        double scalar2D = measure(iterations, [&]() {
+            for (std::size_t i = 0; i < count; i++) {
+                reference[i] = glm::simplex(glm::vec2(x[i], y[i]));
+            }
+        });
+
+        double batch2D = measure(iterations, [&]() {
+            noiseSystem.sample(x, y, result);
+        });
+
+        for (std::size_t i = 0; i < count; i++) {
+            maxError = std::max(maxError, std::abs(reference[i] - result[i]));
+        }
+
+        double scalar3D = measure(iterations, [&]() {
+            for (std::size_t i = 0; i < count; i++) {
+                reference[i] = glm::simplex(glm::vec3(x[i], y[i], z[i]));
+            }
+        });
+
+        double batch3D = measure(iterations, [&]() {
+            noiseSystem.sample(x, y, z, result);
+        });
+
+        for (std::size_t i = 0; i < count; i++) {
+            maxError = std::max(maxError, std::abs(reference[i] - result[i]));
+        }
+
+        std::println("{:>10} {:>14.2f} {:>14.2f} {:>14.2f} {:>14.2f} {:>12.2e}", count, scalar2D, batch2D, scalar3D, batch3D, maxError);
+    }
+}
\ No newline at end of file
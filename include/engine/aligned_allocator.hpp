@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace engine {
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) {
+        }
+
+        T* allocate(std::size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* pointer, std::size_t) {
+            ::operator delete(pointer, std::align_val_t{Alignment});
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const {
+            return true;
+        }
+    };
+}
\ No newline at end of file
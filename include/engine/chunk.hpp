@@ -1,37 +1,108 @@
 #pragma once
 
+#include <engine/chunk_column_spans.hpp>
+#include <engine/chunk_occupation_map.hpp>
+#include <engine/tile_pool.hpp>
+
+#include <span>
 #include <vector>
 
-#include <entt/entt.hpp>
 #include <glm/glm.hpp>
 
+namespace std {
+    template <>
+    struct hash<glm::ivec2> {
+        std::size_t operator()(const glm::ivec2& v) const noexcept {
+            std::size_t h1 = std::hash<int>()(v.x);
+            std::size_t h2 = std::hash<int>()(v.y);
+
+            std::size_t seed = h1;
+            seed ^= h2 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    template <>
+    struct hash<glm::ivec3> {
+        std::size_t operator()(const glm::ivec3& v) const noexcept {
+            std::size_t h1 = std::hash<int>()(v.x);
+            std::size_t h2 = std::hash<int>()(v.y);
+            std::size_t h3 = std::hash<int>()(v.z);
+
+            std::size_t seed = h1;
+            seed ^= h2 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= h3 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+}
+
 namespace engine {
     class Engine;
 
-    struct Chunk {
-        std::vector<entt::entity> tiles;
+    struct Tile {
+        glm::vec2 textureOffset = {0.0, 0.0};
+        glm::vec2 textureScale = {0.1, 0.1};
 
-        glm::ivec3 position;
+        bool visible = false;
     };
 
-    struct ChunkOccupationMap {
-        ChunkOccupationMap(glm::uvec3 dimensions, const glm::ivec3& pos) {
-            entries.resize(dimensions.x, std::vector<std::vector<std::uint8_t>>(dimensions.y, std::vector<std::uint8_t>(dimensions.z, 0)));
-            position = pos;
-        }
+    // Terrain never moves, so a chunk has no registry entities. Its tiles live in the
+    // tile pool as one pre-sorted group that is released as a whole, its column spans
+    // answer terrain queries on the main thread
+    struct Chunk {
+        glm::ivec3 position;
+
+        ChunkColumnSpans spans;
 
-        ChunkOccupationMap() = default;
+        std::uint32_t group = NoTileGroup;
+    };
+
+    struct ChunkBuild {
+        std::vector<TileInstance> instances;
+        std::vector<std::int64_t> orders;
 
-        std::vector<std::vector<std::vector<std::uint8_t>>> entries;
+        ChunkColumnSpans spans;
 
         glm::ivec3 position;
     };
 
+    // Terrain heights of one column of chunks, stored as the thresholds the occupation
+    // fill compares against. Every loaded chunk in the column holds a reference, the
+    // noise is only sampled once a chunk in the column has to be generated. The edges
+    // hold the neighbouring columns at x = -1 (by z) and z = -1 (by x) so tiles on the
+    // border can be culled without the neighbouring chunk
+    struct ChunkHeightmap {
+        std::vector<std::int32_t> solid;
+        std::vector<std::int32_t> surface;
+        std::vector<std::int32_t> edgeSolidX;
+        std::vector<std::int32_t> edgeSurfaceX;
+        std::vector<std::int32_t> edgeSolidZ;
+        std::vector<std::int32_t> edgeSurfaceZ;
+
+        std::uint32_t references = 0;
+
+        bool sampled = false;
+    };
+
+    // Screen directions of the world axes (the x axis sits at atan(0.5) radians)
+    // and the world-to-screen unit scale. tile.vert mirrors these constants
+    constexpr glm::vec2 IsometricAxisX = {0.894427191f, 0.447213595f};
+    constexpr glm::vec2 IsometricAxisY = {0.0f, 1.0f};
+    constexpr glm::vec2 IsometricAxisZ = {-0.894427191f, 0.447213595f};
+    constexpr glm::vec3 IsometricUnitScale = {0.558f, 0.5f, 0.558f};
+
     glm::vec2 worldToScreenSpace(glm::vec3 position);
     glm::vec3 screenToWorldSpace(glm::vec2 screen, float y = 0.0f);
 
-    void determineChunkTiles(engine::ChunkOccupationMap& occupationMap, engine::Engine& engine);
-    void generateChunk(engine::Chunk& chunk, engine::ChunkOccupationMap& occupationMap, engine::Engine& engine);
-    void sortTiles(engine::Engine& engine);
+    std::int64_t computeTileOrder(glm::vec3 position, glm::ivec3 chunkSize);
+
+    void computeChunkHeightmap(engine::ChunkHeightmap& heightmap, glm::ivec2 column, engine::Engine& engine);
+    void determineChunkTiles(engine::ChunkOccupationMap& occupationMap, const engine::ChunkHeightmap& heightmap);
+    void determineChunkSpans(engine::ChunkColumnSpans& columnSpans, const engine::ChunkHeightmap& heightmap);
+    void determineChunkSpans(engine::ChunkColumnSpans& columnSpans, const engine::ChunkOccupationMap& occupationMap);
+    void generateChunk(engine::ChunkBuild& build, const engine::ChunkOccupationMap& occupationMap, std::span<const engine::Tile> tilesAvailable);
+    void generateChunk(engine::ChunkBuild& build, const engine::ChunkColumnSpans& columnSpans, std::span<const engine::Tile> tilesAvailable);
+    void instantiateChunk(engine::Chunk& chunk, engine::ChunkBuild&& build, engine::Engine& engine);
     void unloadChunk(engine::Chunk& chunk, engine::Engine& engine);
 }
\ No newline at end of file
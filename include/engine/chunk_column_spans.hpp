@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace engine {
+    struct ColumnSpan {
+        // One past the last cell of the run, runs start where the previous one ended
+        std::int32_t end = 0;
+
+        std::uint8_t value = 0;
+    };
+
+    // Terrain of a chunk as runs of equal values up each column, bottom first. Next to
+    // the chunk's own columns (indexed like a layer) it holds the x = -1 columns (by z)
+    // and the z = -1 columns (by x), and every column runs one cell past the top so the
+    // layer above is covered too. A heightfield needs at most three runs per column
+    struct ChunkColumnSpans {
+        ChunkColumnSpans(glm::uvec3 dimensions, const glm::ivec3& pos);
+        ChunkColumnSpans() = default;
+
+        std::size_t layerSize() const {
+            return static_cast<std::size_t>(extent.x) * static_cast<std::size_t>(extent.z);
+        }
+
+        std::size_t column(std::int32_t x, std::int32_t z) const {
+            return static_cast<std::size_t>(z) * static_cast<std::size_t>(extent.x) + static_cast<std::size_t>(x);
+        }
+
+        std::size_t edgeColumnX(std::int32_t z) const {
+            return layerSize() + static_cast<std::size_t>(z);
+        }
+
+        std::size_t edgeColumnZ(std::int32_t x) const {
+            return layerSize() + static_cast<std::size_t>(extent.z) + static_cast<std::size_t>(x);
+        }
+
+        std::size_t columnCount() const {
+            return layerSize() + static_cast<std::size_t>(extent.x) + static_cast<std::size_t>(extent.z);
+        }
+
+        std::span<const ColumnSpan> getRuns(std::size_t column) const {
+            return std::span(runs).subspan(offsets[column], offsets[column + 1] - offsets[column]);
+        }
+
+        std::uint8_t at(std::size_t column, std::int32_t y) const;
+
+        std::uint8_t at(std::int32_t x, std::int32_t y, std::int32_t z) const {
+            return at(column(x, z), y);
+        }
+
+        bool isOccupied(std::int32_t x, std::int32_t y, std::int32_t z) const {
+            return at(x, y, z) != 0;
+        }
+
+        // Highest occupied cell of a column inside the chunk, -1 when it is all air
+        std::int32_t findTopTile(std::int32_t x, std::int32_t z) const;
+
+        // Columns are written in order, one run at a time. Empty runs are dropped and
+        // runs continuing the previous value are merged into it
+        void appendRun(std::int32_t end, std::uint8_t value);
+        void finishColumn();
+
+        void clear();
+
+        std::vector<ColumnSpan> runs;
+        std::vector<std::uint32_t> offsets = {0};
+
+        glm::ivec3 extent = {0, 0, 0};
+        glm::ivec3 position = {0, 0, 0};
+    };
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <engine/aligned_allocator.hpp>
+#include <engine/paletted_voxels.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace engine {
+    // One flat buffer per chunk, laid out y-major so that every layer is a contiguous
+    // run of extent.x * extent.z bytes with x varying fastest
+    struct ChunkOccupationMap {
+        ChunkOccupationMap(glm::uvec3 dimensions, const glm::ivec3& pos);
+        ChunkOccupationMap() = default;
+
+        std::size_t index(std::int32_t x, std::int32_t y, std::int32_t z) const {
+            return (static_cast<std::size_t>(y) * static_cast<std::size_t>(extent.z) + static_cast<std::size_t>(z)) * static_cast<std::size_t>(extent.x) + static_cast<std::size_t>(x);
+        }
+
+        std::uint8_t& at(std::int32_t x, std::int32_t y, std::int32_t z) {
+            return entries[index(x, y, z)];
+        }
+
+        std::uint8_t at(std::int32_t x, std::int32_t y, std::int32_t z) const {
+            return entries[index(x, y, z)];
+        }
+
+        std::size_t layerSize() const {
+            return static_cast<std::size_t>(extent.x) * static_cast<std::size_t>(extent.z);
+        }
+
+        std::span<std::uint8_t> layer(std::int32_t y) {
+            return std::span(entries).subspan(static_cast<std::size_t>(y) * layerSize(), layerSize());
+        }
+
+        constexpr static std::size_t Alignment = 64;
+
+        std::vector<std::uint8_t, AlignedAllocator<std::uint8_t, Alignment>> entries;
+
+        // Cells just outside the camera-facing sides, used to cull covered tiles: the
+        // layer above (indexed like a layer), the x = -1 plane (y * extent.z + z) and the
+        // z = -1 plane (y * extent.x + x)
+        std::vector<std::uint8_t> aboveLayer;
+        std::vector<std::uint8_t> edgeX;
+        std::vector<std::uint8_t> edgeZ;
+
+        glm::ivec3 extent = {0, 0, 0};
+        glm::ivec3 position = {0, 0, 0};
+    };
+
+    // Resident form of a built chunk. The flat map is only needed while the chunk is
+    // generated, afterwards its cells and borders are kept palette-compressed
+    struct PackedOccupation {
+        PalettedVoxels entries;
+        PalettedVoxels aboveLayer;
+        PalettedVoxels edgeX;
+        PalettedVoxels edgeZ;
+
+        glm::ivec3 extent = {0, 0, 0};
+        glm::ivec3 position = {0, 0, 0};
+
+        std::size_t getMemoryUsage() const {
+            return entries.getMemoryUsage() + aboveLayer.getMemoryUsage() + edgeX.getMemoryUsage() + edgeZ.getMemoryUsage();
+        }
+    };
+
+    // Occupancy of a cell from its column's thresholds, 2 when solid, 1 at the surface
+    // and 0 above it
+    inline std::uint8_t computeOccupation(std::int32_t worldY, std::int32_t solid, std::int32_t surface) {
+        return static_cast<std::uint8_t>((worldY < solid) + (worldY < surface));
+    }
+
+    // Fills every layer from per-column thresholds (indexed like a layer): cells below
+    // solid[i] become 2, cells below surface[i] become 1 and the rest 0
+    void fillOccupationLayers(ChunkOccupationMap& occupationMap, std::span<const std::int32_t> solid, std::span<const std::int32_t> surface);
+
+    // Records hold the chunk position followed by (value, varint length) runs over the
+    // entries and the culling borders. Decoding fails on any mismatch
+    void encodeOccupation(const ChunkOccupationMap& occupationMap, std::vector<std::uint8_t>& record);
+    bool decodeOccupation(std::span<const std::uint8_t> record, ChunkOccupationMap& occupationMap);
+
+    void packOccupation(const ChunkOccupationMap& occupationMap, PackedOccupation& packed);
+    void unpackOccupation(const PackedOccupation& packed, ChunkOccupationMap& occupationMap);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <engine/chunk.hpp>
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace engine {
+    // Everything the world thread keeps for a chunk, enough to show it again without
+    // touching the region files or the noise. A revisit hands the finished build straight
+    // back, the packed occupation is what is left once the cache gives the build up
+    struct ResidentChunk {
+        PackedOccupation occupation;
+
+        std::optional<ChunkBuild> build;
+    };
+
+    struct ChunkResidencyStats {
+        float loadsPerSecond = 0.0f;
+        float unloadsPerSecond = 0.0f;
+        float revisitsPerSecond = 0.0f;
+
+        std::size_t cachedChunks = 0;
+        std::size_t cachedBytes = 0;
+    };
+
+    // Chunks that left the view, least recently unloaded first out once the memory
+    // budget is exceeded. The oldest entries give up their builds before any entry is
+    // dropped, a revisit then rebuilds the tiles from the occupation
+    class ChunkResidencyCache {
+    public:
+        void setBudget(std::size_t bytes);
+
+        void insert(glm::ivec3 position, ResidentChunk&& chunk);
+        std::optional<ResidentChunk> take(glm::ivec3 position);
+
+        void clear();
+
+        std::size_t size() const {
+            return index_.size();
+        }
+
+        std::size_t getMemoryUsage() const {
+            return usage_;
+        }
+
+        static std::size_t measure(const ResidentChunk& chunk);
+
+    private:
+        struct Entry {
+            glm::ivec3 position;
+
+            ResidentChunk chunk;
+
+            std::size_t bytes = 0;
+        };
+
+        void evict();
+
+        std::list<Entry> entries_;
+        std::unordered_map<glm::ivec3, std::list<Entry>::iterator> index_;
+
+        // Entries from here to the back have given up their builds
+        std::list<Entry>::iterator stripped_ = entries_.end();
+
+        std::size_t budget_ = 0;
+        std::size_t usage_ = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace engine {
+    // Flat open addressing map from chunk position to T. The index is linear probing
+    // kept at most half full with backward shift deletion, so a lookup is almost always
+    // one probe. Values sit in a dense slot array where a chunk keeps its slot for as
+    // long as it is loaded, and freed slots are reused before the array grows
+    template <typename T>
+    class ChunkTable {
+    public:
+        T* find(glm::ivec3 position) {
+            const std::size_t bucket = locate(position);
+
+            return bucket == NoBucket ? nullptr : &slots_[buckets_[bucket].slot].value;
+        }
+
+        const T* find(glm::ivec3 position) const {
+            const std::size_t bucket = locate(position);
+
+            return bucket == NoBucket ? nullptr : &slots_[buckets_[bucket].slot].value;
+        }
+
+        bool contains(glm::ivec3 position) const {
+            return locate(position) != NoBucket;
+        }
+
+        T& insert(glm::ivec3 position, T&& value) {
+            if ((count_ + 1) * 2 > buckets_.size()) {
+                rehash(std::max<std::size_t>(buckets_.size() * 2, MinimumBuckets));
+            }
+
+            std::size_t bucket = home(position);
+
+            for (; buckets_[bucket].slot != EmptySlot; bucket = (bucket + 1) & mask_) {
+                if (buckets_[bucket].position == position) {
+                    return slots_[buckets_[bucket].slot].value = std::move(value);
+                }
+            }
+
+            std::uint32_t slot;
+
+            if (!freeSlots_.empty()) {
+                slot = freeSlots_.back();
+                freeSlots_.pop_back();
+
+                slots_[slot] = Slot{position, std::move(value), true};
+            }
+            else {
+                slot = static_cast<std::uint32_t>(slots_.size());
+
+                slots_.push_back(Slot{position, std::move(value), true});
+            }
+
+            buckets_[bucket] = Bucket{position, slot};
+            count_++;
+
+            return slots_[slot].value;
+        }
+
+        T& operator[](glm::ivec3 position) {
+            if (T* value = find(position)) {
+                return *value;
+            }
+
+            return insert(position, T{});
+        }
+
+        std::optional<T> take(glm::ivec3 position) {
+            const std::size_t bucket = locate(position);
+
+            if (bucket == NoBucket) {
+                return std::nullopt;
+            }
+
+            std::optional<T> value = std::move(slots_[buckets_[bucket].slot].value);
+
+            remove(bucket);
+
+            return value;
+        }
+
+        bool erase(glm::ivec3 position) {
+            const std::size_t bucket = locate(position);
+
+            if (bucket == NoBucket) {
+                return false;
+            }
+
+            remove(bucket);
+
+            return true;
+        }
+
+        template <typename Function>
+        void forEach(Function&& function) {
+            for (Slot& slot : slots_) {
+                if (slot.used) {
+                    function(slot.position, slot.value);
+                }
+            }
+        }
+
+        void reserve(std::size_t count) {
+            std::size_t capacity = MinimumBuckets;
+
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+
+            if (capacity > buckets_.size()) {
+                rehash(capacity);
+            }
+
+            slots_.reserve(count);
+        }
+
+        void clear() {
+            buckets_.assign(buckets_.size(), Bucket{});
+            slots_.clear();
+            freeSlots_.clear();
+            count_ = 0;
+        }
+
+        std::size_t size() const {
+            return count_;
+        }
+
+        bool empty() const {
+            return count_ == 0;
+        }
+
+    private:
+        constexpr static std::uint32_t EmptySlot = std::numeric_limits<std::uint32_t>::max();
+        constexpr static std::size_t NoBucket = std::numeric_limits<std::size_t>::max();
+        constexpr static std::size_t MinimumBuckets = 64;
+
+        struct Bucket {
+            glm::ivec3 position = {};
+            std::uint32_t slot = EmptySlot;
+        };
+
+        struct Slot {
+            glm::ivec3 position = {};
+            T value = {};
+            bool used = false;
+        };
+
+        // Chunk positions are multiples of the chunk size, so the low bits carry
+        // nothing until the coordinates are mixed
+        std::size_t home(glm::ivec3 position) const {
+            std::uint64_t hash = static_cast<std::uint32_t>(position.x) * 0x9E3779B97F4A7C15ull;
+
+            hash ^= static_cast<std::uint32_t>(position.y) * 0xC2B2AE3D27D4EB4Full;
+            hash ^= static_cast<std::uint32_t>(position.z) * 0x165667B19E3779F9ull;
+            hash ^= hash >> 31;
+            hash *= 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 29;
+
+            return static_cast<std::size_t>(hash) & mask_;
+        }
+
+        std::size_t locate(glm::ivec3 position) const {
+            if (count_ == 0) {
+                return NoBucket;
+            }
+
+            for (std::size_t bucket = home(position); buckets_[bucket].slot != EmptySlot; bucket = (bucket + 1) & mask_) {
+                if (buckets_[bucket].position == position) {
+                    return bucket;
+                }
+            }
+
+            return NoBucket;
+        }
+
+        void remove(std::size_t bucket) {
+            Slot& slot = slots_[buckets_[bucket].slot];
+
+            slot.value = T{};
+            slot.used = false;
+
+            freeSlots_.push_back(buckets_[bucket].slot);
+            count_--;
+
+            // Pull later members of the probe run back into the hole as long as that
+            // does not move them in front of their home bucket
+            std::size_t hole = bucket;
+
+            for (std::size_t next = (hole + 1) & mask_; buckets_[next].slot != EmptySlot; next = (next + 1) & mask_) {
+                const std::size_t distance = (next - home(buckets_[next].position)) & mask_;
+
+                if (distance >= ((next - hole) & mask_)) {
+                    buckets_[hole] = buckets_[next];
+                    hole = next;
+                }
+            }
+
+            buckets_[hole] = Bucket{};
+        }
+
+        void rehash(std::size_t capacity) {
+            buckets_.assign(capacity, Bucket{});
+            mask_ = capacity - 1;
+
+            for (std::uint32_t slot = 0; slot < slots_.size(); slot++) {
+                if (!slots_[slot].used) {
+                    continue;
+                }
+
+                std::size_t bucket = home(slots_[slot].position);
+
+                while (buckets_[bucket].slot != EmptySlot) {
+                    bucket = (bucket + 1) & mask_;
+                }
+
+                buckets_[bucket] = Bucket{slots_[slot].position, slot};
+            }
+        }
+
+        std::vector<Bucket> buckets_;
+        std::vector<Slot> slots_;
+        std::vector<std::uint32_t> freeSlots_;
+
+        std::size_t mask_ = 0;
+        std::size_t count_ = 0;
+    };
+}
\ No newline at end of file
@@ -7,13 +7,18 @@
 
 #include <engine/input_manager.hpp>
 #include <engine/renderer.hpp>
+#include <engine/settings.hpp>
 #include <engine/staging_manager.hpp>
 #include <engine/tile_mesh.hpp>
+#include <engine/tile_palette.hpp>
 #include <engine/tile_pool.hpp>
+#include <engine/worker_pool.hpp>
+#include <engine/world_commands.hpp>
 #include <engine/world_generator.hpp>
 
 #include <entt/entt.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <semaphore>
 #include <thread>
@@ -59,10 +64,22 @@ namespace engine {
             return cameraBuffer_;
         }
 
+        auto& getTilePalette() {
+            return tilePalette_;
+        }
+
         auto& getWorldGenerator() {
             return worldGenerator_;
         }
 
+        auto& getWorldCommandQueue() {
+            return worldCommands_;
+        }
+
+        auto& getWorkerPool() {
+            return workerPool_;
+        }
+
         auto& getWindow() {
             return window_;
         }
@@ -132,17 +149,21 @@ namespace engine {
         std::vector<vulkanite::renderer::DescriptorSet> descriptorSets_;
         std::vector<vulkanite::renderer::CommandBuffer> transferCommandBuffers_;
 
+        Settings settings_;
+        WorkerPool workerPool_;
         StagingManager stagingManager_;
         TileMesh worldTileMesh_;
         TileMesh entityTileMesh_;
+        TilePalette tilePalette_;
         TimePoint lastFrameTime_;
         TimePoint thisFrameTime_;
         InputManager inputManager_;
         WorldGenerator worldGenerator_;
+        WorldCommandQueue worldCommands_;
         TilePool worldTilePool_;
         TilePool entityTilePool_;
 
-        bool running_ = true;
+        std::atomic<bool> running_ = true;
         float deltaTime_ = 0.1f;
     };
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine {
+    // Voxel values stored as indices into a small per-container palette, bit-packed at
+    // 1, 2, 4 or 8 bits per voxel depending on the palette size. A container holding
+    // a single value keeps no index words at all
+    class PalettedVoxels {
+    public:
+        PalettedVoxels() = default;
+        explicit PalettedVoxels(std::size_t count, std::uint8_t value = 0);
+
+        std::uint8_t get(std::size_t index) const {
+            if (bits_ == 0) {
+                return uniform_;
+            }
+
+            const std::size_t bit = index * bits_;
+            const std::uint64_t word = words_[getPaletteWords() + (bit >> 6)];
+
+            return getPaletteData()[(word >> (bit & 63)) & ((std::uint64_t{1} << bits_) - 1)];
+        }
+
+        void set(std::size_t index, std::uint8_t value);
+        void fill(std::uint8_t value);
+
+        // Bulk conversion from and to one byte per voxel. Packing rebuilds the palette
+        // from the values actually present
+        void pack(std::span<const std::uint8_t> values);
+        void unpack(std::span<std::uint8_t> values) const;
+
+        std::size_t size() const {
+            return count_;
+        }
+
+        bool isUniform() const {
+            return bits_ == 0;
+        }
+
+        std::uint32_t getBitsPerVoxel() const {
+            return bits_;
+        }
+
+        std::span<const std::uint8_t> getPalette() const {
+            return bits_ == 0 ? std::span<const std::uint8_t>(&uniform_, 1) : std::span<const std::uint8_t>(getPaletteData(), paletteSize_);
+        }
+
+        // Heap bytes only, the container itself is counted by whoever holds it
+        std::size_t getMemoryUsage() const {
+            return words_.capacity() * sizeof(std::uint64_t);
+        }
+
+        static std::uint32_t getBitsForPalette(std::size_t paletteSize);
+
+    private:
+        const std::uint8_t* getPaletteData() const {
+            return reinterpret_cast<const std::uint8_t*>(words_.data());
+        }
+
+        std::size_t getPaletteWords() const {
+            return (static_cast<std::size_t>(paletteSize_) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+        }
+
+        // The palette bytes lead the index words in the same allocation so a container
+        // stays at 32 bytes and uniform ones allocate nothing
+        std::vector<std::uint64_t> words_;
+
+        std::uint32_t count_ = 0;
+        std::uint16_t paletteSize_ = 1;
+        std::uint8_t bits_ = 0;
+        std::uint8_t uniform_ = 0;
+    };
+}
\ No newline at end of file
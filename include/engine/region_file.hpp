@@ -0,0 +1,104 @@
+#pragma once
+
+#include <engine/chunk.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <span>
+#include <unordered_map>
+
+namespace engine {
+    struct RegionSlot {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    struct RegionHeader {
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+
+        glm::ivec3 chunkExtent = {0, 0, 0};
+    };
+
+    // One file per cube of RegionExtent^3 chunks: a header, a table with the offset and
+    // size of every chunk record, then the records themselves. Records are appended and
+    // read back through a memory mapping that is refreshed after writes, so a span from
+    // read() points into the mapping and is only valid until the next write()
+    class RegionFile {
+    public:
+        RegionFile(const std::filesystem::path& path, glm::ivec3 chunkExtent);
+        ~RegionFile();
+
+        RegionFile(const RegionFile&) = delete;
+        RegionFile& operator=(const RegionFile&) = delete;
+
+        std::span<const std::uint8_t> read(std::size_t slot);
+        void write(std::size_t slot, std::span<const std::uint8_t> record);
+
+        constexpr static std::int32_t RegionExtent = 8;
+        constexpr static std::size_t SlotCount = RegionExtent * RegionExtent * RegionExtent;
+
+        constexpr static std::uint32_t Magic = 0x4E474552;
+        constexpr static std::uint32_t Version = 1;
+
+    private:
+        void map();
+        void unmap();
+
+        std::filesystem::path path_;
+        std::fstream stream_;
+
+        std::array<RegionSlot, SlotCount> table_ = {};
+
+        const std::uint8_t* mapping_ = nullptr;
+
+        std::size_t mappingSize_ = 0;
+        std::size_t fileSize_ = 0;
+    };
+
+    // Finds the region file of a chunk by its world position, opening regions as they
+    // are first touched. A closed cache finds nothing and stores nothing. Records found
+    // stay valid until the next store(), trim() or close(), and only trim() closes the
+    // least recently used regions past MaxOpenRegions
+    class RegionCache {
+    public:
+        void open(const std::filesystem::path& directory, glm::ivec3 chunkExtent);
+        void close();
+        void trim();
+
+        bool isOpen() const {
+            return open_;
+        }
+
+        std::span<const std::uint8_t> find(glm::ivec3 position);
+        void store(glm::ivec3 position, std::span<const std::uint8_t> record);
+
+        std::size_t getOpenRegionCount() const {
+            return regions_.size();
+        }
+
+        constexpr static std::size_t MaxOpenRegions = 64;
+
+    private:
+        struct Entry {
+            glm::ivec3 region;
+
+            std::unique_ptr<RegionFile> file;
+        };
+
+        RegionFile& getRegion(glm::ivec3 position, std::size_t& slot);
+
+        std::list<Entry> entries_;
+        std::unordered_map<glm::ivec3, std::list<Entry>::iterator> regions_;
+
+        std::filesystem::path directory_;
+
+        glm::ivec3 chunkExtent_ = {0, 0, 0};
+
+        bool open_ = false;
+    };
+}
\ No newline at end of file
@@ -9,18 +9,43 @@ namespace engine {
         std::string filepath;
 
         struct Display {
-            glm::uvec2 size;
+            glm::uvec2 size = {1280, 720};
 
-            vulkanite::window::Visibility mode;
+            vulkanite::window::Visibility mode = vulkanite::window::Visibility::WINDOWED;
         } display;
 
         struct Graphics {
-            bool vsync;
+            bool vsync = true;
 
-            std::uint32_t imageCount;
-            std::uint32_t renderAheadLimit;
+            std::uint32_t imageCount = 3;
+            std::uint32_t renderAheadLimit = 2;
         } graphics;
 
+        struct Performance {
+            // 0 picks one thread per hardware core
+            std::uint32_t workerThreads = 0;
+        } performance;
+
+        struct World {
+            // Generated chunks are cached here, an empty path turns the cache off
+            std::string regionDirectory = "world/regions";
+
+            // Memory kept for chunks that left the view, in MiB
+            std::uint32_t residencyBudget = 64;
+
+            // How many chunks past the view a chunk has to be before it unloads
+            std::uint32_t unloadMargin = 1;
+
+            // Time the world thread spends loading chunks per tick in microseconds, 0 has no limit
+            std::uint32_t streamBudget = 4000;
+
+            // How far ahead of the camera's movement chunks are loaded in milliseconds
+            std::uint32_t prefetchTime = 1000;
+
+            // Time spent reclaiming the tiles of unloaded chunks per frame in microseconds, 0 has no limit
+            std::uint32_t unloadBudget = 1000;
+        } world;
+
         static Settings load();
         static void save(const Settings& settings);
     };
@@ -18,19 +18,41 @@ namespace engine {
         void create(Engine& engine);
         void setBaseMesh(const std::array<glm::vec2, 4>& vertices);
         void createInstanceBuffer(std::size_t instanceCount);
-        void setInstances(std::span<TileInstance> instances);
+        void setTransforms(std::span<const TileTransform> transforms, std::span<const TileRange> ranges);
+        void setPaletteIndices(std::span<const std::uint32_t> paletteIndices, std::span<const TileRange> ranges);
+        void setDrawRanges(std::span<const TileRange> ranges);
 
         auto getMeshBuffer() const {
             return meshBuffer_;
         }
 
-        auto getInstanceBuffer() const {
-            return instanceBuffer_;
+        auto getTransformBuffer() const {
+            return transformBuffer_;
+        }
+
+        auto getPaletteIndexBuffer() const {
+            return paletteIndexBuffer_;
+        }
+
+        auto getInstanceCount() const {
+            return instanceCount_;
+        }
+
+        auto& getDrawRanges() const {
+            return drawRanges_;
         }
 
     private:
+        void uploadRanges(vulkanite::renderer::Buffer& buffer, const void* data, std::size_t stride, std::span<const TileRange> ranges);
+
         vulkanite::renderer::Buffer meshBuffer_;
-        vulkanite::renderer::Buffer instanceBuffer_;
+        vulkanite::renderer::Buffer transformBuffer_;
+        vulkanite::renderer::Buffer paletteIndexBuffer_;
+
+        std::vector<vulkanite::renderer::BufferCopyRegion> copyRegions_;
+        std::vector<TileRange> drawRanges_;
+
+        std::size_t instanceCount_ = 0;
 
         Engine* engine_;
     };
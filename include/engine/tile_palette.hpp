@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vulkanite/renderer/renderer.hpp>
+
+#include <engine/tile_pool.hpp>
+
+#include <array>
+#include <vector>
+
+namespace engine {
+    class Engine;
+
+    class TilePalette {
+    public:
+        ~TilePalette();
+
+        void create(Engine& engine);
+        void set(std::uint32_t index, const TileAppearance& appearance);
+        void upload();
+
+        std::uint32_t allocateOverride(const TileAppearance& appearance);
+        void releaseOverride(std::uint32_t index);
+
+        const TileAppearance& get(std::uint32_t index) const {
+            return entries_[index];
+        }
+
+        auto getBuffer() const {
+            return buffer_;
+        }
+
+        constexpr static std::uint32_t TileCount = 256;
+        constexpr static std::uint32_t OverrideCount = 64;
+        constexpr static std::uint32_t Capacity = TileCount + OverrideCount;
+
+    private:
+        std::array<TileAppearance, Capacity> entries_ = {};
+        std::vector<std::uint32_t> freedOverrides_;
+
+        vulkanite::renderer::Buffer buffer_;
+
+        Engine* engine_;
+
+        std::uint32_t nextOverride_ = TileCount;
+        std::uint32_t dirtyBegin_ = Capacity;
+        std::uint32_t dirtyEnd_ = 0;
+    };
+}
\ No newline at end of file
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <engine/tile_sorter.hpp>
+#include <engine/triple_buffer.hpp>
+
+#include <chrono>
+#include <limits>
 #include <span>
 #include <vector>
 
@@ -14,29 +19,95 @@ namespace components {
 }
 
 namespace engine {
+    constexpr std::uint32_t NoTileGroup = std::numeric_limits<std::uint32_t>::max();
+
     struct TileData {
         std::int64_t order = 0;
+        std::uint32_t group = NoTileGroup;
+    };
+
+    struct TileRange {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    struct TileGroup {
+        TileRange range;
+
+        std::size_t count = 0;
+
+        bool used = false;
+        bool released = false;
+    };
+
+    struct TileTransform {
+        glm::ivec3 position;
+
+        std::uint32_t scale;
+    };
+
+    struct TileAppearance {
+        struct Texture {
+            struct Sample {
+                glm::vec2 position;
+                glm::vec2 extent;
+            } sample;
+
+            glm::vec2 offset;
+            glm::vec2 repeat;
+        } texture;
+
+        glm::vec4 colourFactor;
+    };
+
+    struct TileInstance {
+        TileTransform transform;
+
+        std::uint32_t paletteIndex = 0;
+    };
+
+    struct TileSnapshot {
+        std::vector<TileData> data;
+        std::vector<std::size_t> proxies;
+
+        std::uint64_t version = 0;
     };
 
-    struct alignas(16) TileInstance {
-        struct Transform {
-            glm::vec2 position;
-            glm::vec2 scale;
-        } transform;
-
-        struct Appearance {
-            struct Texture {
-                struct Sample {
-                    glm::vec2 position;
-                    glm::vec2 extent;
-                } sample;
-
-                glm::vec2 offset;
-                glm::vec2 repeat;
-            } texture;
-
-            glm::vec4 colourFactor;
-        } appearance;
+    struct TileSnapshotOrdering {
+        std::vector<std::size_t> proxies;
+
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        std::uint64_t version = 0;
+    };
+
+    constexpr std::int32_t TileSubdivisions = 256;
+
+    glm::ivec3 packTilePosition(glm::vec3 position);
+    glm::vec3 unpackTilePosition(glm::ivec3 position);
+
+    std::uint32_t packTileScale(glm::vec2 scale);
+    glm::vec2 unpackTileScale(std::uint32_t scale);
+
+    class WorkerPool;
+
+    class TileRangeSet {
+    public:
+        void mark(std::size_t begin, std::size_t end);
+        void clear();
+
+        std::span<const TileRange> get(std::size_t size);
+
+        constexpr static std::size_t MergeDistance = 8;
+        constexpr static std::size_t CoalesceThreshold = 4096;
+
+    private:
+        void coalesce(std::size_t size);
+        void closeGaps(std::size_t count);
+
+        std::vector<TileRange> ranges_;
+        std::vector<std::size_t> gapScratch_;
     };
 
     class TilePool {
@@ -44,22 +115,71 @@ namespace engine {
         TilePool();
 
         components::TileProxy insert(const TileInstance& base, std::int64_t order);
+        std::span<const components::TileProxy> insertBatch(std::span<const TileInstance> bases, std::span<const std::int64_t> orders, std::uint32_t group = NoTileGroup);
 
-        TileInstance& getInstance(components::TileProxy proxy);
+        // The mutable accessors mark the slot for upload, readers go through the const
+        // overload and per-frame writers through setTransform, which only marks changes
+        TileTransform& getTransform(components::TileProxy proxy);
+        const TileTransform& getTransform(components::TileProxy proxy) const;
+        std::uint32_t& getPaletteIndex(components::TileProxy proxy);
         TileData& getData(components::TileProxy proxy);
 
+        void setTransform(components::TileProxy proxy, const TileTransform& transform);
+        void setOrder(components::TileProxy proxy, std::int64_t order);
+
         void remove(components::TileProxy proxy);
         bool contains(components::TileProxy proxy) const;
 
         void clear();
-        void sortByDepth();
+        bool sortByDepth();
+
+        // Groups keep their tiles in one dense run as long as their order keys share
+        // a band (see computeTileOrder). Releasing a group only hides its run, the
+        // tiles are dropped by compact()
+        std::uint32_t createGroup();
+        void releaseGroup(std::uint32_t group);
+        TileRange getGroupRange(std::uint32_t group);
+
+        std::span<const TileRange> getLiveRanges();
+
+        // Reclaims released tiles by sliding the survivors down over them. A pass can
+        // span several calls when it runs past the budget, 0 has no limit. While a pass
+        // is unfinished sortByDepth, snapshots and orderings wait for it and return false
+        void compact(std::chrono::microseconds budget = std::chrono::microseconds(0));
+
+        bool isCompacting() const {
+            return compacting_;
+        }
+
+        // Snapshot sorting lets another thread own the sort. The owning thread captures
+        // the order keys while the sorting thread is idle, the sorting thread publishes
+        // an ordering of proxies, and the owner applies the newest one at any time
+        bool captureSnapshot();
+        void sortSnapshot();
+        bool applyOrdering();
+
+        void markDirty(std::size_t begin, std::size_t end);
+        void clearDirtyRanges();
+
+        std::span<const TileRange> getDirtyTransformRanges();
+        std::span<const TileRange> getDirtyPaletteIndexRanges();
+
+        void setWorkerPool(WorkerPool* workerPool);
+
+        std::span<TileTransform> transforms() {
+            return transforms_;
+        }
 
-        std::span<TileInstance> instances() {
-            return instances_;
+        std::span<const TileTransform> transforms() const {
+            return transforms_;
         }
 
-        std::span<const TileInstance> instances() const {
-            return instances_;
+        std::span<std::uint32_t> paletteIndices() {
+            return paletteIndices_;
+        }
+
+        std::span<const std::uint32_t> paletteIndices() const {
+            return paletteIndices_;
         }
 
         std::span<TileData> data() {
@@ -70,18 +190,65 @@ namespace engine {
             return data_;
         }
 
-        std::vector<std::size_t>& getProxyGroup(std::size_t index);
+        std::size_t size() const {
+            return data_.size();
+        }
 
         constexpr static std::size_t DeadIndex = std::numeric_limits<std::size_t>::max();
+        constexpr static std::size_t CompactGrain = 4096;
 
     private:
-        std::vector<std::vector<std::size_t>> groupTable_;
+        template <typename Source>
+        void reorder(std::size_t begin, std::size_t end, Source source);
+
+        void refreshGroups();
+        void finishCompaction();
+
+        TileRange getCompactionGap() const {
+            return compacting_ ? TileRange{compactWrite_, compactRead_} : TileRange{data_.size(), data_.size()};
+        }
+
+        std::vector<TileGroup> groupTable_;
+        std::vector<std::uint32_t> freedGroups_;
+        std::vector<TileRange> liveRanges_;
+        std::vector<TileRange> releasedScratch_;
         std::vector<std::size_t> table_;
         std::vector<std::size_t> reverse_;
         std::vector<std::size_t> freed_;
-        std::vector<TileInstance> instances_;
+        std::vector<TileTransform> transforms_;
+        std::vector<std::uint32_t> paletteIndices_;
         std::vector<TileData> data_;
 
+        TileRangeSet transformRanges_;
+        TileRangeSet paletteIndexRanges_;
+
+        TileSorter sorter_;
+        TileSorter snapshotSorter_;
+
+        TileSnapshot snapshot_;
+        TripleBuffer<TileSnapshotOrdering> orderings_;
+
+        WorkerPool* workerPool_ = nullptr;
+
+        std::uint64_t version_ = 0;
+
+        std::size_t releasedGroupCount_ = 0;
+        std::size_t compactRead_ = 0;
+        std::size_t compactWrite_ = 0;
+
+        bool groupsStale_ = false;
+        bool snapshotStale_ = true;
+        bool snapshotPending_ = false;
+        bool compacting_ = false;
+
+        std::vector<TileTransform> transformScratch_;
+        std::vector<std::uint32_t> paletteIndexScratch_;
+        std::vector<TileData> dataScratch_;
+        std::vector<std::size_t> reverseScratch_;
+        std::vector<std::size_t> orderScratch_;
+        std::vector<std::uint8_t> placedScratch_;
+        std::vector<components::TileProxy> proxyScratch_;
+
         static std::uint32_t maxIdentifier_;
         std::uint32_t identifier_;
     };
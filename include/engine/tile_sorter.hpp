@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine {
+    struct TileData;
+
+    class WorkerPool;
+
+    struct TileOrdering {
+        std::span<const std::uint32_t> permutation;
+
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        bool empty() const {
+            return begin == end;
+        }
+    };
+
+    class TileSorter {
+    public:
+        TileOrdering sort(std::span<const TileData> data);
+
+        bool usedFullRebuild() const {
+            return fullRebuild_;
+        }
+
+        void setWorkerPool(WorkerPool* workerPool) {
+            workerPool_ = workerPool;
+        }
+
+        constexpr static std::size_t IncrementalDivisor = 16;
+        constexpr static std::size_t MaxMergedRuns = 16;
+        constexpr static std::size_t ParallelGrain = 16384;
+
+    private:
+        void computeKeys(std::span<const TileData> data);
+        void radixSort();
+        void parallelRadixSort();
+        bool incrementalSort();
+        bool mergeRuns();
+
+        TileOrdering finalise();
+
+        std::vector<std::uint64_t> keys_;
+        std::vector<std::uint64_t> keyScratch_;
+        std::vector<std::uint32_t> permutation_;
+        std::vector<std::uint32_t> permutationScratch_;
+        std::vector<std::uint32_t> kept_;
+        std::vector<std::uint32_t> displaced_;
+        std::vector<std::size_t> runs_;
+        std::vector<std::array<std::uint32_t, 256>> histograms_;
+
+        WorkerPool* workerPool_ = nullptr;
+
+        bool fullRebuild_ = false;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace engine {
+    // Single producer, single consumer handoff. The writer fills back() and publishes
+    // it, the reader picks up the most recent publication with update() and reads
+    // front(). Neither side ever blocks or sees a slot the other one is using
+    template <typename T>
+    class TripleBuffer {
+    public:
+        T& back() {
+            return slots_[back_];
+        }
+
+        const T& front() const {
+            return slots_[front_];
+        }
+
+        void publish() {
+            back_ = state_.exchange(back_ | FreshBit, std::memory_order_acq_rel) & IndexMask;
+        }
+
+        bool update() {
+            if ((state_.load(std::memory_order_relaxed) & FreshBit) == 0) {
+                return false;
+            }
+
+            front_ = state_.exchange(front_, std::memory_order_acq_rel) & IndexMask;
+
+            return true;
+        }
+
+    private:
+        constexpr static std::uint8_t IndexMask = 0x3;
+        constexpr static std::uint8_t FreshBit = 0x4;
+
+        std::array<T, 3> slots_;
+
+        std::atomic<std::uint8_t> state_ = 1;
+
+        std::uint8_t back_ = 0;
+        std::uint8_t front_ = 2;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine {
+    struct WorkRange {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    // Fork-join pool. The calling thread works alongside the workers and run() returns
+    // once every task has finished. Only one job runs at a time, a second caller just
+    // runs its tasks inline
+    class WorkerPool {
+    public:
+        ~WorkerPool();
+
+        void create(std::size_t threadCount);
+        void destroy();
+
+        void run(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+        std::size_t getTaskCount(std::size_t count, std::size_t grain) const;
+
+        std::size_t getThreadCount() const {
+            return workers_.size() + 1;
+        }
+
+        static WorkRange split(std::size_t count, std::size_t parts, std::size_t part);
+
+    private:
+        void work();
+        void drain();
+
+        std::vector<std::thread> workers_;
+
+        std::mutex submitMutex_;
+        std::mutex mutex_;
+        std::condition_variable wakeCondition_;
+        std::condition_variable doneCondition_;
+
+        const std::function<void(std::size_t)>* task_ = nullptr;
+
+        std::size_t taskCount_ = 0;
+        std::size_t nextTask_ = 0;
+        std::size_t finishedTasks_ = 0;
+        std::size_t activeWorkers_ = 0;
+        std::uint64_t generation_ = 0;
+
+        bool stopping_ = false;
+    };
+
+    // Splits [0, count) into slices of at least grain elements across the pool, or
+    // runs it inline when there is no pool
+    void parallelFor(WorkerPool* pool, std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <engine/chunk.hpp>
+#include <engine/chunk_table.hpp>
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace engine {
+    class Engine;
+
+    enum class WorldCommandType {
+        CREATE_CHUNK,
+        DESTROY_CHUNK,
+    };
+
+    struct WorldCommand {
+        WorldCommandType type;
+
+        ChunkBuild build;
+    };
+
+    class WorldCommandList {
+    public:
+        void createChunk(ChunkBuild&& build);
+        void destroyChunk(glm::ivec3 position);
+
+        void clear() {
+            commands_.clear();
+        }
+
+        bool empty() const {
+            return commands_.empty();
+        }
+
+    private:
+        std::vector<WorldCommand> commands_;
+
+        friend class WorldCommandQueue;
+    };
+
+    class WorldCommandQueue {
+    public:
+        void submit(WorldCommandList& list);
+        void apply(Engine& engine);
+
+        // Terrain queries against the chunks applied so far, main thread only. Cells of
+        // chunks that are not loaded read as empty
+        bool isOccupied(glm::ivec3 position, glm::ivec3 chunkSize) const;
+
+        // Highest occupied cell of the column through position, looking down from the top
+        // of the chunk that holds it until the loaded chunks run out
+        std::optional<std::int32_t> findTopTile(glm::ivec3 position, glm::ivec3 chunkSize) const;
+
+    private:
+        std::vector<WorldCommand> pending_;
+        std::vector<WorldCommand> applying_;
+
+        ChunkTable<Chunk> chunks_;
+
+        std::mutex mutex_;
+    };
+}
\ No newline at end of file
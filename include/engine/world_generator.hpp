@@ -1,40 +1,97 @@
 #pragma once
 
 #include <engine/chunk.hpp>
-
+#include <engine/chunk_residency.hpp>
+#include <engine/chunk_table.hpp>
+#include <engine/region_file.hpp>
+#include <engine/tile_palette.hpp>
+#include <engine/world_commands.hpp>
+#include <engine/world_noise.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <tuple>
 #include <unordered_map>
-
-namespace std {
-    template <>
-    struct hash<glm::ivec3> {
-        std::size_t operator()(const glm::ivec3& v) const noexcept {
-            std::size_t h1 = std::hash<int>()(v.x);
-            std::size_t h2 = std::hash<int>()(v.y);
-            std::size_t h3 = std::hash<int>()(v.z);
-
-            std::size_t seed = h1;
-            seed ^= h2 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h3 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            return seed;
-        }
-    };
-}
+#include <utility>
+#include <vector>
 
 namespace engine {
     class Engine;
 
-    class WorldNoiseSystem {
-    public:
-        float sample(const glm::vec3& position);
+    struct PendingChunk {
+        ChunkOccupationMap occupation;
+        ChunkBuild build;
 
-    private:
+        ChunkHeightmap* heightmap = nullptr;
+
+        // Points into a region mapping, only read while the batch builds. Storing the
+        // batch's new records or trimming the cache can unmap it
+        std::span<const std::uint8_t> record;
+        std::vector<std::uint8_t> encoded;
+
+        // Set for revisits whose build the residency cache gave up, they rebuild from the
+        // occupation it kept
+        std::optional<PackedOccupation> resident;
+
+        bool built = false;
     };
 
-    struct Tile {
-        glm::vec2 textureOffset = {0.0, 0.0};
-        glm::vec2 textureScale = {0.1, 0.1};
+    struct StreamRequest {
+        glm::ivec3 position = {0, 0, 0};
+
+        // Squared distance to the camera in chunks
+        std::int64_t distance = 0;
+
+        struct Farther {
+            bool operator()(const StreamRequest& a, const StreamRequest& b) const {
+                if (a.distance != b.distance) {
+                    return a.distance > b.distance;
+                }
+
+                return std::tie(a.position.x, a.position.y, a.position.z) > std::tie(b.position.x, b.position.y, b.position.z);
+            }
+        };
+    };
+
+    struct ChunkSpan {
+        std::int32_t begin = 0;
+        std::int32_t end = 0;
+    };
+
+    struct ChunkRowSpans {
+        ChunkSpan load;
+        ChunkSpan keep;
+    };
+
+    // Everything the visible set depends on. The camera is snapped to its chunk so the
+    // view only changes when the camera crosses a chunk border or zooms
+    struct WorldView {
+        glm::ivec3 cameraChunk = {0, 0, 0};
+        glm::ivec3 prefetchOffset = {0, 0, 0};
+        glm::vec2 scale = {0.0f, 0.0f};
+        glm::ivec3 worldSize = {0, 0, 0};
+
+        std::uint32_t unloadMargin = 0;
+
+        bool valid = false;
+
+        // Chunks considered for loading, worldSize around both the camera and the
+        // predicted camera position
+        glm::ivec3 getWindowBegin() const {
+            const glm::ivec3 lower = glm::min(cameraChunk, cameraChunk + prefetchOffset);
+
+            return {lower.x - worldSize.x, -worldSize.y, lower.z - worldSize.z};
+        }
+
+        glm::ivec3 getWindowEnd() const {
+            const glm::ivec3 upper = glm::max(cameraChunk, cameraChunk + prefetchOffset);
+
+            return {upper.x + worldSize.x, worldSize.y, upper.z + worldSize.z};
+        }
 
-        bool visible = false;
+        bool operator==(const WorldView&) const = default;
     };
 
     class WorldGenerator {
@@ -43,6 +100,11 @@ namespace engine {
 
         void setWorldSize(glm::ivec3 size);
         void setChunkSize(glm::ivec3 size);
+        void setRegionDirectory(const std::filesystem::path& directory);
+        void setResidencyBudget(std::size_t bytes);
+        void setUnloadMargin(std::uint32_t chunks);
+        void setStreamBudget(std::chrono::microseconds budget);
+        void setPrefetchTime(std::chrono::milliseconds time);
 
         glm::ivec3 getWorldSize() const {
             return worldSize_;
@@ -56,11 +118,79 @@ namespace engine {
             return availableTiles_;
         }
 
+        auto& getNoiseSystem() {
+            return noiseSystem_;
+        }
+
+        std::size_t getQueuedChunkCount() const {
+            return requestedChunks_.size();
+        }
+
+        ChunkResidencyStats getResidencyStats();
+
+        void writePalette(TilePalette& palette) const;
+        void setView(glm::vec3 cameraPosition, glm::vec2 cameraScale, glm::vec3 cameraVelocity = {0.0f, 0.0f, 0.0f});
+
         void generate();
 
+        constexpr static std::size_t StreamBatchPerThread = 4;
+        constexpr static std::int32_t MaxPrefetchSteps = 16;
+
     private:
-        std::unordered_map<glm::ivec3, Chunk> loadedChunks_;
-        std::unordered_map<glm::ivec3, ChunkOccupationMap> loadedChunkOccupations_;
+        WorldView captureView();
+        ChunkRowSpans computeRowSpans(const WorldView& view, std::int32_t y, std::int32_t z) const;
+
+        void updateFrontier(const WorldView& view);
+        void prioritiseRequests();
+        void streamChunks();
+        void buildPendingChunks();
+
+        void loadChunk(glm::ivec3 position);
+        void evictChunk(glm::ivec3 position);
+
+        ChunkHeightmap* acquireHeightmap(glm::ivec2 column);
+        void requestHeightmap(glm::ivec2 column, ChunkHeightmap* heightmap);
+        void releaseHeightmap(glm::ivec2 column);
+
+        void buildChunk(PendingChunk& pending);
+        void updateResidencyStats();
+
+        ChunkTable<ResidentChunk> loadedChunks_;
+        std::unordered_map<glm::ivec2, ChunkHeightmap> loadedHeightmaps_;
+
+        std::vector<StreamRequest> streamQueue_;
+        ChunkTable<bool> requestedChunks_;
+
+        std::vector<PendingChunk> pendingChunks_;
+        std::vector<std::pair<glm::ivec2, ChunkHeightmap*>> pendingHeightmaps_;
+
+        WorldCommandList commands_;
+
+        WorldNoiseSystem noiseSystem_;
+        RegionCache regionCache_;
+        ChunkResidencyCache residencyCache_;
+
+        std::mutex viewMutex_;
+        std::mutex statsMutex_;
+
+        ChunkResidencyStats residencyStats_;
+
+        std::chrono::steady_clock::time_point statsWindowStart_ = std::chrono::steady_clock::now();
+
+        std::size_t windowLoads_ = 0;
+        std::size_t windowUnloads_ = 0;
+        std::size_t windowRevisits_ = 0;
+
+        std::uint32_t unloadMargin_ = 1;
+
+        std::chrono::microseconds streamBudget_ = std::chrono::microseconds(0);
+        std::chrono::milliseconds prefetchTime_ = std::chrono::milliseconds(0);
+
+        glm::vec3 cameraPosition_ = {0.0f, 0.0f, 0.0f};
+        glm::vec3 cameraVelocity_ = {0.0f, 0.0f, 0.0f};
+        glm::vec2 cameraScale_ = {1.0f, 1.0f};
+
+        WorldView currentView_;
 
         std::array<Tile, 256> availableTiles_;
 
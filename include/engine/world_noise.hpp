@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace engine {
+    // Simplex noise matching glm::simplex, evaluated a full SIMD register of samples
+    // at a time. Batches take the coordinates as separate arrays and may be any size,
+    // the remainder is padded out to one more register
+    class WorldNoiseSystem {
+    public:
+        float sample(const glm::vec2& position) const;
+        float sample(const glm::vec3& position) const;
+
+        void sample(std::span<const float> x, std::span<const float> y, std::span<float> result) const;
+        void sample(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<float> result) const;
+
+        static std::size_t getBatchWidth();
+    };
+}
\ No newline at end of file
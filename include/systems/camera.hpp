@@ -1,6 +1,7 @@
 #pragma once
 
 #include <entt/entt.hpp>
+#include <glm/glm.hpp>
 
 namespace engine {
     class Engine;
@@ -11,5 +12,6 @@ namespace systems::cameras {
     void animateCameraSizes(engine::Engine& engine);
     void animateCameraPositions(engine::Engine& engine);
     void makeCamerasFollowTarget(engine::Engine& engine);
+    glm::vec3 getCameraVelocity(engine::Engine& engine);
     void uploadCameraData(engine::Engine& engine);
 }
\ No newline at end of file
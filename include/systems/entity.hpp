@@ -10,4 +10,5 @@ namespace systems::entities {
     void createEntities(engine::Engine& engine);
     void sortEntities(engine::Engine& engine);
     void updateControllers(engine::Engine& engine);
+    void placeOnTerrain(engine::Engine& engine);
 }
\ No newline at end of file
@@ -2,39 +2,34 @@
 #include <engine/engine.hpp>
 #include <engine/tile_pool.hpp>
 
-#include <components/tags.hpp>
-#include <components/transforms.hpp>
-
-#include <glm/gtc/noise.hpp>
+#include <algorithm>
+
+namespace {
+    engine::TileInstance makeTerrainTile(glm::ivec3 worldPosition, std::uint8_t tileIndex) {
+        return {
+            .transform = {
+                .position = worldPosition * engine::TileSubdivisions,
+                .scale = engine::packTileScale({1.0f, 1.0f}),
+            },
+            .paletteIndex = tileIndex,
+        };
+    }
+}
 
 glm::vec2 engine::worldToScreenSpace(glm::vec3 position) {
-    constexpr float radX = 0.463647609001f;
-    constexpr float radZ = M_PI - radX;
-
-    glm::vec2 dirX = {std::cos(radX), std::sin(radX)};
-    glm::vec2 dirY = {0.0f, 1.0f};
-    glm::vec2 dirZ = {std::cos(radZ), std::sin(radZ)};
-
-    constexpr glm::vec3 unitScale = {0.558f, 0.5f, 0.558f};
-
-    return (dirX * position.x * unitScale.x + dirY * position.y * unitScale.y + dirZ * position.z * unitScale.z);
+    return IsometricAxisX * position.x * IsometricUnitScale.x + IsometricAxisY * position.y * IsometricUnitScale.y + IsometricAxisZ * position.z * IsometricUnitScale.z;
 }
 
 glm::vec3 engine::screenToWorldSpace(glm::vec2 screen, float y) {
-    constexpr float radX = 0.463647609001f;
-    constexpr float radZ = M_PI - radX;
-
-    constexpr glm::vec3 unitScale = {0.558f, 0.5f, 0.558f};
-
     const float u = screen.x;
-    const float v = screen.y - y * unitScale.y;
+    const float v = screen.y - y * IsometricUnitScale.y;
 
-    const float a = std::cos(radX) * unitScale.x;
-    const float b = std::cos(radZ) * unitScale.z;
-    const float c = std::sin(radX) * unitScale.x;
-    const float d = std::sin(radZ) * unitScale.z;
+    constexpr float a = IsometricAxisX.x * IsometricUnitScale.x;
+    constexpr float b = IsometricAxisZ.x * IsometricUnitScale.z;
+    constexpr float c = IsometricAxisX.y * IsometricUnitScale.x;
+    constexpr float d = IsometricAxisZ.y * IsometricUnitScale.z;
 
-    const float determinant = a * d - b * c;
+    constexpr float determinant = a * d - b * c;
 
     const float x = (u * d - b * v) / determinant;
     const float z = (-u * c + a * v) / determinant;
@@ -42,109 +37,351 @@ glm::vec3 engine::screenToWorldSpace(glm::vec2 screen, float y) {
     return {x, y, z};
 }
 
-void engine::determineChunkTiles(engine::ChunkOccupationMap& occupationMap, engine::Engine& engine) {
+std::int64_t engine::computeTileOrder(glm::vec3 position, glm::ivec3 chunkSize) {
+    const glm::vec3 extent = glm::vec3(chunkSize);
+    const glm::vec3 chunk = glm::floor(position / extent);
+    const glm::vec3 local = position - chunk * extent;
+
+    // Chunk-major keys keep every chunk in one contiguous run of the pool. Chunks go
+    // bottom layer first and far (+x, +z) to near within a layer, which is a valid
+    // painter's order for grid-aligned boxes, and tiles keep their usual order inside
+    const std::int64_t chunkY = 1023 - static_cast<std::int64_t>(chunk.y);
+    const std::int64_t chunkX = static_cast<std::int64_t>(chunk.x) + 32768;
+    const std::int64_t chunkZ = static_cast<std::int64_t>(chunk.z) + 32768;
+
+    const double localOrder = (extent.y - local.y) * (extent.x + extent.z - 1.0f) + local.x + local.z;
+
+    const std::int64_t chunkRank = (chunkY << 32) | (chunkX << 16) | chunkZ;
+
+    return (chunkRank << 20) | std::clamp<std::int64_t>(static_cast<std::int64_t>(localOrder), 0, (1 << 20) - 1);
+}
+
+void engine::computeChunkHeightmap(engine::ChunkHeightmap& heightmap, glm::ivec2 column, engine::Engine& engine) {
     auto& worldGenerator = engine.getWorldGenerator();
 
     auto chunkExtent = worldGenerator.getChunkSize();
 
-    for (std::int64_t x = 0; x < chunkExtent.x; x++) {
-        for (std::int64_t z = 0; z < chunkExtent.z; z++) {
-            glm::vec2 worldPosition = glm::vec2(occupationMap.position.x, occupationMap.position.z) + glm::vec2{x, z};
-
-            float noise = glm::simplex(worldPosition * 0.02f);
+    auto& noiseSystem = worldGenerator.getNoiseSystem();
 
-            noise = (noise * 0.5f) + 0.5f;
+    const std::size_t layerSize = static_cast<std::size_t>(chunkExtent.x) * chunkExtent.z;
+    const std::size_t sampleCount = layerSize + chunkExtent.z + chunkExtent.x;
 
-            float height = (worldGenerator.getWorldSize().y + chunkExtent.y) * noise;
+    std::vector<float> sampleX(sampleCount);
+    std::vector<float> sampleZ(sampleCount);
+    std::vector<float> noise(sampleCount);
 
-            for (std::int64_t y = 0; y < chunkExtent.y; y++) {
-                std::int64_t worldY = y + occupationMap.position.y;
+    auto setSample = [&](std::size_t index, std::int32_t x, std::int32_t z) {
+        sampleX[index] = static_cast<float>(column.x + x) * 0.02f;
+        sampleZ[index] = static_cast<float>(column.y + z) * 0.02f;
+    };
 
-                if (worldY < static_cast<std::int32_t>(height - 1)) {
-                    occupationMap.entries[x][y][z] = 2;
-                }
-                else if (worldY < static_cast<std::int32_t>(height)) {
-                    occupationMap.entries[x][y][z] = 1;
-                }
-                else {
-                    occupationMap.entries[x][y][z] = 0;
-                }
-            }
+    // The layer comes first, followed by the x = -1 and z = -1 edges
+    for (std::int32_t z = 0; z < chunkExtent.z; z++) {
+        for (std::int32_t x = 0; x < chunkExtent.x; x++) {
+            setSample(static_cast<std::size_t>(z) * chunkExtent.x + x, x, z);
         }
     }
+
+    for (std::int32_t z = 0; z < chunkExtent.z; z++) {
+        setSample(layerSize + z, -1, z);
+    }
+
+    for (std::int32_t x = 0; x < chunkExtent.x; x++) {
+        setSample(layerSize + chunkExtent.z + x, x, -1);
+    }
+
+    noiseSystem.sample(sampleX, sampleZ, noise);
+
+    const float scale = static_cast<float>(worldGenerator.getWorldSize().y + chunkExtent.y);
+
+    auto writeThresholds = [&](std::vector<std::int32_t>& solid, std::vector<std::int32_t>& surface, std::size_t first, std::size_t count) {
+        solid.resize(count);
+        surface.resize(count);
+
+        for (std::size_t i = 0; i < count; i++) {
+            const float height = scale * ((noise[first + i] * 0.5f) + 0.5f);
+
+            solid[i] = static_cast<std::int32_t>(height - 1);
+            surface[i] = static_cast<std::int32_t>(height);
+        }
+    };
+
+    writeThresholds(heightmap.solid, heightmap.surface, 0, layerSize);
+    writeThresholds(heightmap.edgeSolidX, heightmap.edgeSurfaceX, layerSize, chunkExtent.z);
+    writeThresholds(heightmap.edgeSolidZ, heightmap.edgeSurfaceZ, layerSize + chunkExtent.z, chunkExtent.x);
 }
 
-void engine::generateChunk(engine::Chunk& chunk, engine::ChunkOccupationMap& occupationMap, engine::Engine& engine) {
-    auto& registry = engine.getRegistry();
-    auto& tilePool = engine.getEntityTilePool();
-    auto& worldGenerator = engine.getWorldGenerator();
+void engine::determineChunkTiles(engine::ChunkOccupationMap& occupationMap, const engine::ChunkHeightmap& heightmap) {
+    fillOccupationLayers(occupationMap, heightmap.solid, heightmap.surface);
 
-    auto chunkExtent = worldGenerator.getChunkSize();
+    const glm::ivec3 extent = occupationMap.extent;
+    const std::int32_t aboveY = occupationMap.position.y + extent.y;
 
-    chunk.tiles.reserve(static_cast<std::size_t>(chunkExtent.x * chunkExtent.y * chunkExtent.z));
+    for (std::size_t column = 0; column < occupationMap.aboveLayer.size(); column++) {
+        occupationMap.aboveLayer[column] = computeOccupation(aboveY, heightmap.solid[column], heightmap.surface[column]);
+    }
 
-    auto tilesAvailable = worldGenerator.getAvailableTiles();
+    for (std::int32_t y = 0; y < extent.y; y++) {
+        const std::int32_t worldY = occupationMap.position.y + y;
 
-    for (std::int64_t y = 0; y < chunkExtent.y; y++) {
-        for (std::int64_t x = 0; x < chunkExtent.x; x++) {
-            for (std::int64_t z = 0; z < chunkExtent.z; z++) {
+        for (std::int32_t z = 0; z < extent.z; z++) {
+            occupationMap.edgeX[static_cast<std::size_t>(y) * extent.z + z] = computeOccupation(worldY, heightmap.edgeSolidX[z], heightmap.edgeSurfaceX[z]);
+        }
 
-                auto& tileIndex = occupationMap.entries[x][y][z];
-                auto& tileInfo = tilesAvailable[tileIndex];
-                if (tileInfo.visible) {
-                    glm::ivec3 worldPosition = chunk.position + glm::ivec3{x, y, z};
+        for (std::int32_t x = 0; x < extent.x; x++) {
+            occupationMap.edgeZ[static_cast<std::size_t>(y) * extent.x + x] = computeOccupation(worldY, heightmap.edgeSolidZ[x], heightmap.edgeSurfaceZ[x]);
+        }
+    }
+}
 
-                    auto entity = registry.create();
+void engine::determineChunkSpans(engine::ChunkColumnSpans& columnSpans, const engine::ChunkHeightmap& heightmap) {
+    columnSpans.clear();
 
-                    auto& proxy = registry.emplace<components::TileProxy>(entity, tilePool.insert({}, 0));
-                    auto& instance = tilePool.getInstance(proxy);
-                    auto& data = tilePool.getData(proxy);
+    // Same thresholds as computeOccupation: 2 below both, 1 below one of them and 0
+    // above, with every column running one cell into the layer above
+    const std::int32_t top = columnSpans.extent.y + 1;
 
-                    registry.emplace<components::Position>(entity, worldPosition);
-                    registry.emplace<components::TileTag>(entity);
+    auto appendColumn = [&](std::int32_t solid, std::int32_t surface) {
+        const std::int32_t lower = std::min(solid, surface) - columnSpans.position.y;
+        const std::int32_t upper = std::max(solid, surface) - columnSpans.position.y;
 
-                    instance.transform.scale = {1.0f, 1.0f};
-                    instance.transform.position = worldToScreenSpace(worldPosition);
+        columnSpans.appendRun(std::clamp(lower, 0, top), 2);
+        columnSpans.appendRun(std::clamp(upper, 0, top), 1);
+        columnSpans.appendRun(top, 0);
+        columnSpans.finishColumn();
+    };
 
-                    instance.appearance.texture.offset = {0.0, 0.0};
-                    instance.appearance.texture.repeat = {1.0, 1.0};
-                    instance.appearance.texture.sample.extent = tileInfo.textureScale;
-                    instance.appearance.texture.sample.position = tileInfo.textureOffset;
-                    instance.appearance.colourFactor = {1.0, 1.0, 1.0, 1.0};
+    for (std::size_t column = 0; column < columnSpans.layerSize(); column++) {
+        appendColumn(heightmap.solid[column], heightmap.surface[column]);
+    }
 
-                    chunk.tiles.push_back(entity);
-                }
+    for (std::int32_t z = 0; z < columnSpans.extent.z; z++) {
+        appendColumn(heightmap.edgeSolidX[z], heightmap.edgeSurfaceX[z]);
+    }
+
+    for (std::int32_t x = 0; x < columnSpans.extent.x; x++) {
+        appendColumn(heightmap.edgeSolidZ[x], heightmap.edgeSurfaceZ[x]);
+    }
+}
+
+void engine::determineChunkSpans(engine::ChunkColumnSpans& columnSpans, const engine::ChunkOccupationMap& occupationMap) {
+    columnSpans.clear();
+
+    const glm::ivec3 extent = occupationMap.extent;
+    const std::int32_t top = extent.y + 1;
+
+    // Chunks without a heightmap (records and revisits) are run-length coded cell by
+    // cell. The edges have no cell above the chunk, their top cell is carried up
+    for (std::int32_t z = 0; z < extent.z; z++) {
+        for (std::int32_t x = 0; x < extent.x; x++) {
+            for (std::int32_t y = 0; y < extent.y; y++) {
+                columnSpans.appendRun(y + 1, occupationMap.at(x, y, z));
             }
+
+            columnSpans.appendRun(top, occupationMap.aboveLayer[static_cast<std::size_t>(z) * extent.x + x]);
+            columnSpans.finishColumn();
+        }
+    }
+
+    auto appendEdge = [&](std::span<const std::uint8_t> edge, std::int32_t index, std::int32_t stride) {
+        for (std::int32_t y = 0; y < extent.y; y++) {
+            columnSpans.appendRun(y + 1, edge[static_cast<std::size_t>(y) * stride + index]);
         }
+
+        columnSpans.appendRun(top, edge[static_cast<std::size_t>(extent.y - 1) * stride + index]);
+        columnSpans.finishColumn();
+    };
+
+    for (std::int32_t z = 0; z < extent.z; z++) {
+        appendEdge(occupationMap.edgeX, z, extent.z);
+    }
+
+    for (std::int32_t x = 0; x < extent.x; x++) {
+        appendEdge(occupationMap.edgeZ, x, extent.x);
     }
 }
 
-void engine::sortTiles(engine::Engine& engine) {
-    auto& registry = engine.getRegistry();
-    auto& tilePool = engine.getEntityTilePool();
-    auto& worldGenerator = engine.getWorldGenerator();
+void engine::generateChunk(engine::ChunkBuild& build, const engine::ChunkOccupationMap& occupationMap, std::span<const engine::Tile> tilesAvailable) {
+    const glm::ivec3 chunkExtent = occupationMap.extent;
+
+    build.position = occupationMap.position;
+    build.instances.clear();
+    build.orders.clear();
+
+    auto opaque = [&](std::uint8_t tileIndex) {
+        return tilesAvailable[tileIndex].visible;
+    };
+
+    // The camera only sees the top, -x and -z faces of a tile (+x and +z lie further
+    // away, see computeTileOrder), so a tile with opaque neighbours on those three
+    // sides is fully covered. Neighbours past the chunk edge come from the borders
+    auto occluded = [&](std::int32_t x, std::int32_t y, std::int32_t z) {
+        const std::uint8_t above = y + 1 < chunkExtent.y ? occupationMap.at(x, y + 1, z) : occupationMap.aboveLayer[static_cast<std::size_t>(z) * chunkExtent.x + x];
+        const std::uint8_t nearX = x > 0 ? occupationMap.at(x - 1, y, z) : occupationMap.edgeX[static_cast<std::size_t>(y) * chunkExtent.z + z];
+        const std::uint8_t nearZ = z > 0 ? occupationMap.at(x, y, z - 1) : occupationMap.edgeZ[static_cast<std::size_t>(y) * chunkExtent.x + x];
 
-    auto view = registry.view<components::TileProxy, components::Position, components::TileTag>();
+        return opaque(above) && opaque(nearX) && opaque(nearZ);
+    };
 
-    auto worldSizeTiles = worldGenerator.getWorldSize() * worldGenerator.getChunkSize();
+    // Tiles are emitted in draw order (bottom layer first, far diagonals first) so the
+    // chunk lands in the pool as one pre-sorted run
+    for (std::int32_t y = 0; y < chunkExtent.y; y++) {
+        for (std::int32_t diagonal = chunkExtent.x + chunkExtent.z - 2; diagonal >= 0; diagonal--) {
+            const std::int32_t firstX = std::max(0, diagonal - chunkExtent.z + 1);
+            const std::int32_t lastX = std::min(chunkExtent.x - 1, diagonal);
 
-    for (auto [entity, proxy, position] : view.each()) {
-        auto& data = tilePool.getData(proxy);
+            for (std::int32_t x = firstX; x <= lastX; x++) {
+                const std::int32_t z = diagonal - x;
 
-        data.order = (worldSizeTiles.y - position.position.y) * (worldSizeTiles.x + worldSizeTiles.z - 1) + position.position.x + position.position.z;
+                const std::uint8_t tileIndex = occupationMap.at(x, y, z);
+                auto& tileInfo = tilesAvailable[tileIndex];
+                if (tileInfo.visible && !occluded(x, y, z)) {
+                    const glm::ivec3 worldPosition = build.position + glm::ivec3{x, y, z};
+
+                    build.instances.push_back(makeTerrainTile(worldPosition, tileIndex));
+                    build.orders.push_back(computeTileOrder(worldPosition, chunkExtent));
+                }
+            }
+        }
     }
 }
 
+void engine::instantiateChunk(engine::Chunk& chunk, engine::ChunkBuild&& build, engine::Engine& engine) {
+    auto& tilePool = engine.getEntityTilePool();
+
+    chunk.position = build.position;
+    chunk.spans = std::move(build.spans);
+    chunk.group = tilePool.createGroup();
+
+    tilePool.insertBatch(build.instances, build.orders, chunk.group);
+}
+
 void engine::unloadChunk(engine::Chunk& chunk, engine::Engine& engine) {
-    auto& registry = engine.getRegistry();
     auto& tilePool = engine.getEntityTilePool();
 
-    for (auto& tile : chunk.tiles) {
-        auto& proxy = registry.get<components::TileProxy>(tile);
+    tilePool.releaseGroup(chunk.group);
 
-        tilePool.remove(proxy);
-        registry.destroy(tile);
+    chunk.group = NoTileGroup;
+}
+
+void engine::generateChunk(engine::ChunkBuild& build, const engine::ChunkColumnSpans& columnSpans, std::span<const engine::Tile> tilesAvailable) {
+    const glm::ivec3 chunkExtent = columnSpans.extent;
+
+    build.position = columnSpans.position;
+    build.instances.clear();
+    build.orders.clear();
+
+    struct VisibleRun {
+        std::int32_t x;
+        std::int32_t z;
+        std::int32_t begin;
+        std::int32_t end;
+
+        std::uint8_t value;
+    };
+
+    std::vector<VisibleRun> visibleRuns;
+    std::vector<std::pair<std::int32_t, std::int32_t>> exposed;
+    std::vector<std::uint32_t> layerOffsets(static_cast<std::size_t>(chunkExtent.y) + 1, 0);
+
+    // A run of opaque cells is only uncovered at its top (when the run above is not
+    // opaque) and where the -x or -z neighbour column holds non-opaque runs, see the
+    // occlusion rule of the occupation map version. Those ranges come straight from
+    // the runs, cells in between are never looked at
+    auto exposeNeighbour = [&](std::size_t neighbour, std::int32_t begin, std::int32_t end) {
+        std::int32_t neighbourBegin = 0;
+
+        for (const ColumnSpan& run : columnSpans.getRuns(neighbour)) {
+            if (!tilesAvailable[run.value].visible) {
+                const std::int32_t first = std::max(begin, neighbourBegin);
+                const std::int32_t last = std::min(end, run.end);
+
+                if (first < last) {
+                    exposed.emplace_back(first, last);
+                }
+            }
+
+            neighbourBegin = run.end;
+
+            if (neighbourBegin >= end) {
+                break;
+            }
+        }
+    };
+
+    // Columns are visited in a layer's draw order, so bucketing the cells by layer
+    // afterwards yields the same pre-sorted run as the occupation map version
+    for (std::int32_t diagonal = chunkExtent.x + chunkExtent.z - 2; diagonal >= 0; diagonal--) {
+        const std::int32_t firstX = std::max(0, diagonal - chunkExtent.z + 1);
+        const std::int32_t lastX = std::min(chunkExtent.x - 1, diagonal);
+
+        for (std::int32_t x = firstX; x <= lastX; x++) {
+            const std::int32_t z = diagonal - x;
+
+            const std::span<const ColumnSpan> runs = columnSpans.getRuns(columnSpans.column(x, z));
+            const std::size_t nearX = x > 0 ? columnSpans.column(x - 1, z) : columnSpans.edgeColumnX(z);
+            const std::size_t nearZ = z > 0 ? columnSpans.column(x, z - 1) : columnSpans.edgeColumnZ(x);
+
+            std::int32_t begin = 0;
+
+            for (std::size_t i = 0; i < runs.size() && begin < chunkExtent.y; begin = runs[i++].end) {
+                const std::uint8_t value = runs[i].value;
+
+                if (!tilesAvailable[value].visible) {
+                    continue;
+                }
+
+                const std::int32_t end = std::min(runs[i].end, chunkExtent.y);
+
+                exposed.clear();
+
+                if (i + 1 == runs.size() || !tilesAvailable[runs[i + 1].value].visible) {
+                    exposed.emplace_back(runs[i].end - 1, runs[i].end);
+                }
+
+                exposeNeighbour(nearX, begin, end);
+                exposeNeighbour(nearZ, begin, end);
+
+                std::ranges::sort(exposed);
+
+                for (std::size_t j = 0; j < exposed.size();) {
+                    std::int32_t first = exposed[j].first;
+                    std::int32_t last = exposed[j].second;
+
+                    for (j++; j < exposed.size() && exposed[j].first <= last; j++) {
+                        last = std::max(last, exposed[j].second);
+                    }
+
+                    last = std::min(last, end);
+
+                    if (first >= last) {
+                        continue;
+                    }
+
+                    visibleRuns.push_back({x, z, first, last, value});
+
+                    for (std::int32_t y = first; y < last; y++) {
+                        layerOffsets[static_cast<std::size_t>(y) + 1]++;
+                    }
+                }
+            }
+        }
+    }
+
+    for (std::size_t y = 1; y < layerOffsets.size(); y++) {
+        layerOffsets[y] += layerOffsets[y - 1];
     }
 
-    chunk.tiles.clear();
+    build.instances.resize(layerOffsets.back());
+    build.orders.resize(layerOffsets.back());
+
+    for (const VisibleRun& run : visibleRuns) {
+        for (std::int32_t y = run.begin; y < run.end; y++) {
+            const std::uint32_t slot = layerOffsets[static_cast<std::size_t>(y)]++;
+            const glm::ivec3 worldPosition = build.position + glm::ivec3{run.x, y, run.z};
+
+            build.instances[slot] = makeTerrainTile(worldPosition, run.value);
+            build.orders[slot] = computeTileOrder(worldPosition, chunkExtent);
+        }
+    }
 }
\ No newline at end of file
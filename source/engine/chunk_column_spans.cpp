@@ -0,0 +1,61 @@
+#include <engine/chunk_column_spans.hpp>
+
+#include <algorithm>
+
+engine::ChunkColumnSpans::ChunkColumnSpans(glm::uvec3 dimensions, const glm::ivec3& pos)
+    : extent(dimensions), position(pos) {
+    runs.reserve(columnCount() * 3);
+    offsets.reserve(columnCount() + 1);
+}
+
+std::uint8_t engine::ChunkColumnSpans::at(std::size_t column, std::int32_t y) const {
+    for (const ColumnSpan& run : getRuns(column)) {
+        if (y < run.end) {
+            return run.value;
+        }
+    }
+
+    return 0;
+}
+
+std::int32_t engine::ChunkColumnSpans::findTopTile(std::int32_t x, std::int32_t z) const {
+    const std::span<const ColumnSpan> columnRuns = getRuns(column(x, z));
+
+    for (std::size_t i = columnRuns.size(); i-- > 0;) {
+        const std::int32_t begin = i == 0 ? 0 : columnRuns[i - 1].end;
+
+        if (columnRuns[i].value != 0 && begin < extent.y) {
+            return std::min(columnRuns[i].end, extent.y) - 1;
+        }
+    }
+
+    return -1;
+}
+
+void engine::ChunkColumnSpans::appendRun(std::int32_t end, std::uint8_t value) {
+    const bool columnStarted = runs.size() > offsets.back();
+    const std::int32_t begin = columnStarted ? runs.back().end : 0;
+
+    if (end <= begin) {
+        return;
+    }
+
+    if (columnStarted && runs.back().value == value) {
+        runs.back().end = end;
+        return;
+    }
+
+    runs.push_back({
+        .end = end,
+        .value = value,
+    });
+}
+
+void engine::ChunkColumnSpans::finishColumn() {
+    offsets.push_back(static_cast<std::uint32_t>(runs.size()));
+}
+
+void engine::ChunkColumnSpans::clear() {
+    runs.clear();
+    offsets.assign(1, 0);
+}
\ No newline at end of file
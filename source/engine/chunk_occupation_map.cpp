@@ -0,0 +1,177 @@
+#include <engine/chunk_occupation_map.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+engine::ChunkOccupationMap::ChunkOccupationMap(glm::uvec3 dimensions, const glm::ivec3& pos)
+    : extent(dimensions), position(pos) {
+    entries.resize(static_cast<std::size_t>(dimensions.x) * dimensions.y * dimensions.z);
+    aboveLayer.resize(static_cast<std::size_t>(dimensions.x) * dimensions.z);
+    edgeX.resize(static_cast<std::size_t>(dimensions.y) * dimensions.z);
+    edgeZ.resize(static_cast<std::size_t>(dimensions.y) * dimensions.x);
+}
+
+void engine::fillOccupationLayers(ChunkOccupationMap& occupationMap, std::span<const std::int32_t> solid, std::span<const std::int32_t> surface) {
+    const std::size_t layerSize = occupationMap.layerSize();
+
+    const std::int32_t* solidData = solid.data();
+    const std::int32_t* surfaceData = surface.data();
+
+    // Branchless compares over contiguous arrays so the inner loop vectorises into
+    // packed compares and byte stores
+    for (std::int32_t y = 0; y < occupationMap.extent.y; y++) {
+        const std::int32_t worldY = occupationMap.position.y + y;
+
+        std::uint8_t* __restrict layer = occupationMap.layer(y).data();
+
+        for (std::size_t i = 0; i < layerSize; i++) {
+            layer[i] = computeOccupation(worldY, solidData[i], surfaceData[i]);
+        }
+    }
+}
+
+void engine::encodeOccupation(const ChunkOccupationMap& occupationMap, std::vector<std::uint8_t>& record) {
+    record.resize(sizeof(glm::ivec3));
+
+    std::memcpy(record.data(), &occupationMap.position, sizeof(glm::ivec3));
+
+    auto writeRun = [&](std::uint8_t value, std::size_t length) {
+        record.push_back(value);
+
+        while (length >= 0x80) {
+            record.push_back(static_cast<std::uint8_t>(length | 0x80));
+            length >>= 7;
+        }
+
+        record.push_back(static_cast<std::uint8_t>(length));
+    };
+
+    const std::array<std::span<const std::uint8_t>, 4> sections = {
+        std::span<const std::uint8_t>(occupationMap.entries),
+        occupationMap.aboveLayer,
+        occupationMap.edgeX,
+        occupationMap.edgeZ,
+    };
+
+    // Runs carry on across sections, terrain is mostly long runs of air and stone
+    std::uint8_t value = 0;
+    std::size_t length = 0;
+
+    for (const auto section : sections) {
+        auto cursor = section.begin();
+
+        while (cursor != section.end()) {
+            if (length == 0) {
+                value = *cursor;
+            }
+
+            auto end = std::find_if(cursor, section.end(), [&](std::uint8_t cell) {
+                return cell != value;
+            });
+
+            length += static_cast<std::size_t>(end - cursor);
+            cursor = end;
+
+            if (cursor != section.end()) {
+                writeRun(value, length);
+                length = 0;
+            }
+        }
+    }
+
+    if (length > 0) {
+        writeRun(value, length);
+    }
+}
+
+bool engine::decodeOccupation(std::span<const std::uint8_t> record, ChunkOccupationMap& occupationMap) {
+    glm::ivec3 position;
+
+    if (record.size() < sizeof(glm::ivec3)) {
+        return false;
+    }
+
+    std::memcpy(&position, record.data(), sizeof(glm::ivec3));
+
+    if (position != occupationMap.position) {
+        return false;
+    }
+
+    const std::array<std::span<std::uint8_t>, 4> sections = {
+        std::span<std::uint8_t>(occupationMap.entries),
+        occupationMap.aboveLayer,
+        occupationMap.edgeX,
+        occupationMap.edgeZ,
+    };
+
+    std::size_t section = 0;
+    std::size_t offset = 0;
+    std::size_t cursor = sizeof(glm::ivec3);
+
+    while (cursor < record.size()) {
+        const std::uint8_t value = record[cursor++];
+
+        std::size_t length = 0;
+        std::size_t shift = 0;
+
+        while (true) {
+            if (cursor == record.size() || shift > 56) {
+                return false;
+            }
+
+            const std::uint8_t byte = record[cursor++];
+
+            length |= static_cast<std::size_t>(byte & 0x7F) << shift;
+            shift += 7;
+
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+
+        while (length > 0) {
+            if (section == sections.size()) {
+                return false;
+            }
+
+            const std::size_t count = std::min(length, sections[section].size() - offset);
+
+            std::fill_n(sections[section].begin() + static_cast<std::ptrdiff_t>(offset), count, value);
+
+            offset += count;
+            length -= count;
+
+            if (offset == sections[section].size()) {
+                section++;
+                offset = 0;
+            }
+        }
+    }
+
+    // Empty sections at the end never get a run, so skip past them
+    while (section < sections.size() && sections[section].empty()) {
+        section++;
+    }
+
+    return section == sections.size();
+}
+
+void engine::packOccupation(const ChunkOccupationMap& occupationMap, PackedOccupation& packed) {
+    packed.entries.pack(occupationMap.entries);
+    packed.aboveLayer.pack(occupationMap.aboveLayer);
+    packed.edgeX.pack(occupationMap.edgeX);
+    packed.edgeZ.pack(occupationMap.edgeZ);
+
+    packed.extent = occupationMap.extent;
+    packed.position = occupationMap.position;
+}
+
+void engine::unpackOccupation(const PackedOccupation& packed, ChunkOccupationMap& occupationMap) {
+    occupationMap = ChunkOccupationMap(packed.extent, packed.position);
+
+    packed.entries.unpack(occupationMap.entries);
+    packed.aboveLayer.unpack(occupationMap.aboveLayer);
+    packed.edgeX.unpack(occupationMap.edgeX);
+    packed.edgeZ.unpack(occupationMap.edgeZ);
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <engine/chunk_residency.hpp>
+
+void engine::ChunkResidencyCache::setBudget(std::size_t bytes) {
+    budget_ = bytes;
+
+    evict();
+}
+
+void engine::ChunkResidencyCache::insert(glm::ivec3 position, ResidentChunk&& chunk) {
+    take(position);
+
+    const std::size_t bytes = measure(chunk);
+
+    entries_.push_front({
+        .position = position,
+        .chunk = std::move(chunk),
+        .bytes = bytes,
+    });
+
+    index_[position] = entries_.begin();
+    usage_ += bytes;
+
+    evict();
+}
+
+std::optional<engine::ResidentChunk> engine::ChunkResidencyCache::take(glm::ivec3 position) {
+    auto iterator = index_.find(position);
+
+    if (iterator == index_.end()) {
+        return std::nullopt;
+    }
+
+    auto entry = iterator->second;
+
+    if (entry == stripped_) {
+        stripped_ = std::next(entry);
+    }
+
+    ResidentChunk chunk = std::move(entry->chunk);
+
+    usage_ -= entry->bytes;
+
+    entries_.erase(entry);
+    index_.erase(iterator);
+
+    return chunk;
+}
+
+void engine::ChunkResidencyCache::clear() {
+    entries_.clear();
+    index_.clear();
+
+    stripped_ = entries_.end();
+    usage_ = 0;
+}
+
+std::size_t engine::ChunkResidencyCache::measure(const ResidentChunk& chunk) {
+    std::size_t bytes = sizeof(Entry) + chunk.occupation.getMemoryUsage();
+
+    if (chunk.build) {
+        bytes += chunk.build->instances.capacity() * sizeof(TileInstance) + chunk.build->orders.capacity() * sizeof(std::int64_t);
+        bytes += chunk.build->spans.runs.capacity() * sizeof(ColumnSpan) + chunk.build->spans.offsets.capacity() * sizeof(std::uint32_t);
+    }
+
+    return bytes;
+}
+
+void engine::ChunkResidencyCache::evict() {
+    while (usage_ > budget_ && stripped_ != entries_.begin()) {
+        Entry& entry = *--stripped_;
+
+        entry.chunk.build.reset();
+
+        usage_ -= entry.bytes;
+        entry.bytes = measure(entry.chunk);
+        usage_ += entry.bytes;
+    }
+
+    while (usage_ > budget_ && !entries_.empty()) {
+        if (stripped_ == std::prev(entries_.end())) {
+            stripped_ = entries_.end();
+        }
+
+        const Entry& oldest = entries_.back();
+
+        usage_ -= oldest.bytes;
+
+        index_.erase(oldest.position);
+        entries_.pop_back();
+    }
+}
\ No newline at end of file
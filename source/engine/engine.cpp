@@ -107,6 +107,11 @@ void engine::Engine::run() {
 }
 
 void engine::Engine::start() {
+    settings_ = Settings::load();
+
+    workerPool_.create(settings_.performance.workerThreads);
+    entityTilePool_.setWorkerPool(&workerPool_);
+
     std::int32_t tilemapWidth = 0;
     std::int32_t tilemapHeight = 0;
     std::int32_t tilemapChannels = 0;
@@ -121,6 +126,7 @@ void engine::Engine::start() {
 
     worldTileMesh_.create(*this);
     entityTileMesh_.create(*this);
+    tilePalette_.create(*this);
 
     auto& device = renderer_.getDevice();
     auto& transferQueue = renderer_.getTransferQueue();
@@ -153,16 +159,23 @@ void engine::Engine::start() {
         .binding = 2,
     };
 
+    vulkanite::renderer::DescriptorSetInputInfo paletteInputInfo = {
+        .type = vulkanite::renderer::DescriptorInputType::UNIFORM_BUFFER,
+        .stageFlags = vulkanite::renderer::DescriptorShaderStageFlags::VERTEX,
+        .count = 1,
+        .binding = 3,
+    };
+
     vulkanite::renderer::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
         .device = renderer_.getDevice(),
-        .inputs = {bufferInputInfo, sampler1InputInfo, sampler2InputInfo},
+        .inputs = {bufferInputInfo, sampler1InputInfo, sampler2InputInfo, paletteInputInfo},
     };
 
     descriptorSetLayout_.create(descriptorSetLayoutCreateInfo);
 
     vulkanite::renderer::DescriptorPoolSize bufferSize = {
         .type = vulkanite::renderer::DescriptorInputType::UNIFORM_BUFFER,
-        .count = 1,
+        .count = 2,
     };
 
     vulkanite::renderer::DescriptorPoolSize imageSize = {
@@ -396,24 +409,25 @@ void engine::Engine::start() {
     controller.leftBinding = vulkanite::window::Key::A;
     controller.rightBinding = vulkanite::window::Key::D;
 
+    auto paletteIndex = tilePalette_.allocateOverride({
+        .texture = {
+            .sample = {
+                .position = {0.1, 0.0},
+                .extent = {0.1, 0.1},
+            },
+            .offset = {0.0, 0.0},
+            .repeat = {1.0, 1.0},
+        },
+        .colourFactor = {1.0, 1.0, 1.0, 1.0},
+    });
+
     auto proxy = entityTilePool_.insert(
         {
             .transform = {
-                .position = {0.0, 0.0},
-                .scale = {1.0, 1.0},
-            },
-            .appearance = {
-                .texture = {
-                    .sample = {
-                        .position = {0.1, 0.0},
-                        .extent = {0.1, 0.1},
-                    },
-                    .offset = {0.0, 0.0},
-                    .repeat = {1.0, 1.0},
-                },
-                .colourFactor = {1.0, 1.0, 1.0, 1.0},
-
+                .position = {0, 0, 0},
+                .scale = packTileScale({1.0, 1.0}),
             },
+            .paletteIndex = paletteIndex,
         },
         0);
 
@@ -457,11 +471,21 @@ void engine::Engine::start() {
 
     worldGenerator_.setWorldSize({32, 2, 32});
     worldGenerator_.setChunkSize({8, 8, 8});
+    worldGenerator_.setRegionDirectory(settings_.world.regionDirectory);
+    worldGenerator_.setResidencyBudget(static_cast<std::size_t>(settings_.world.residencyBudget) * 1024 * 1024);
+    worldGenerator_.setUnloadMargin(settings_.world.unloadMargin);
+    worldGenerator_.setStreamBudget(std::chrono::microseconds(settings_.world.streamBudget));
+    worldGenerator_.setPrefetchTime(std::chrono::milliseconds(settings_.world.prefetchTime));
+    worldGenerator_.writePalette(tilePalette_);
+
+    tilePalette_.upload();
 
     entityTileMesh_.createInstanceBuffer(32 * 1024 * 1024);
 
     cameraPosition.position = {0.0f, 0.0f, 0.0f};
 
+    worldGenerator_.setView(cameraPosition.position, cameraScale.scale);
+
     transferCommandBuffer.endCapture();
 
     worldThread_ = std::thread([this]() {
@@ -496,7 +520,22 @@ void engine::Engine::start() {
         .images = {},
     };
 
-    descriptorPool_.updateDescriptorSets({tilemapUniformBufferUpdateInfo});
+    vulkanite::renderer::DescriptorSetBufferBinding paletteBufferBinding = {
+        .buffer = tilePalette_.getBuffer(),
+        .offsetBytes = 0,
+        .rangeBytes = tilePalette_.getBuffer().getSize(),
+    };
+
+    vulkanite::renderer::DescriptorSetUpdateInfo paletteUniformBufferUpdateInfo = {
+        .set = tilemapDescriptorSet_,
+        .inputType = vulkanite::renderer::DescriptorInputType::UNIFORM_BUFFER,
+        .binding = 3,
+        .arrayElement = 0,
+        .buffers = {paletteBufferBinding},
+        .images = {},
+    };
+
+    descriptorPool_.updateDescriptorSets({tilemapUniformBufferUpdateInfo, paletteUniformBufferUpdateInfo});
 
     lastFrameTime_ = std::chrono::high_resolution_clock::now();
 
@@ -554,20 +593,33 @@ void engine::Engine::runPreTransferSystems() {
     ::systems::entities::updateControllers(*this);
 
     ::systems::integrateMovements(*this);
+    ::systems::entities::placeOnTerrain(*this);
 
     ::systems::cameras::animateCameraPositions(*this);
     ::systems::cameras::animateCameraSizes(*this);
     ::systems::cameras::makeCamerasFollowTarget(*this);
     ::systems::cameras::calculateCameraData(*this);
 
-    if (worldWaitSemaphore_.try_acquire()) {
-        ::systems::transformInstances(*this, entityTilePool_);
-        worldSignalSemaphore_.release();
-    }
+    auto& cameraPosition = registry_.get<Position>(currentCamera_);
+    auto& cameraScale = registry_.get<Scale>(currentCamera_);
+
+    worldGenerator_.setView(cameraPosition.position, cameraScale.scale, ::systems::cameras::getCameraVelocity(*this));
+
+    worldCommands_.apply(*this);
+
+    ::systems::transformInstances(*this, entityTilePool_);
+    ::systems::entities::sortEntities(*this);
+
+    entityTilePool_.applyOrdering();
 }
 
 void engine::Engine::runMidTransferSystems() {
-    entityTileMesh_.setInstances(entityTilePool_.instances());
+    entityTileMesh_.setTransforms(entityTilePool_.transforms(), entityTilePool_.getDirtyTransformRanges());
+    entityTileMesh_.setPaletteIndices(entityTilePool_.paletteIndices(), entityTilePool_.getDirtyPaletteIndexRanges());
+    entityTileMesh_.setDrawRanges(entityTilePool_.getLiveRanges());
+    entityTilePool_.clearDirtyRanges();
+
+    tilePalette_.upload();
 
     ::systems::cameras::uploadCameraData(*this);
 }
@@ -577,6 +629,13 @@ void engine::Engine::runPostTransferSystems() {
     ::systems::cacheLasts<Position>(registry_);
     ::systems::cacheLasts<Velocity>(registry_);
     ::systems::cacheLasts<Acceleration>(registry_);
+
+    entityTilePool_.compact(std::chrono::microseconds(settings_.world.unloadBudget));
+
+    if (worldWaitSemaphore_.try_acquire()) {
+        entityTilePool_.captureSnapshot();
+        worldSignalSemaphore_.release();
+    }
 }
 
 void engine::Engine::update() {
@@ -664,8 +723,11 @@ void engine::Engine::render() {
     // renderer::CommandBuffer::draw(commandBuffer, 4, static_cast<std::uint32_t>(worldTilePool_.data().size()), 0, 0);
 
     commandBuffer.bindDescriptorSets(vulkanite::renderer::DeviceOperation::GRAPHICS, pipelineLayout_, 0, {tilemapDescriptorSet_});
-    commandBuffer.bindVertexBuffers({entityTileMesh_.getMeshBuffer(), entityTileMesh_.getInstanceBuffer()}, {0, 0}, 0);
-    commandBuffer.draw(4, static_cast<std::uint32_t>(entityTilePool_.data().size()), 0, 0);
+    commandBuffer.bindVertexBuffers({entityTileMesh_.getMeshBuffer(), entityTileMesh_.getTransformBuffer(), entityTileMesh_.getPaletteIndexBuffer()}, {0, 0, 0}, 0);
+
+    for (const auto& range : entityTileMesh_.getDrawRanges()) {
+        commandBuffer.draw(4, static_cast<std::uint32_t>(range.end - range.begin), 0, static_cast<std::uint32_t>(range.begin));
+    }
 
     commandBuffer.endRenderPass();
     commandBuffer.endCapture();
@@ -685,22 +747,31 @@ void engine::Engine::render() {
 }
 
 void engine::Engine::worldUpdate() {
-    while (running_) {
+    while (true) {
         worldSignalSemaphore_.acquire();
-        worldGenerator_.generate();
 
-        sortTiles(*this);
+        if (!running_) {
+            worldWaitSemaphore_.release();
+            break;
+        }
+
+        worldGenerator_.generate();
 
-        entityTilePool_.sortByDepth();
+        entityTilePool_.sortSnapshot();
         worldWaitSemaphore_.release();
     }
 }
 
 void engine::Engine::close() {
     if (worldThread_.joinable()) {
+        worldWaitSemaphore_.acquire();
+        worldSignalSemaphore_.release();
+
         worldThread_.join();
     }
 
+    workerPool_.destroy();
+
     auto& device = renderer_.getDevice();
 
     device.waitIdle();
@@ -779,7 +850,12 @@ void engine::Engine::createBasicPipelineResources() {
                 vulkanite::renderer::VertexInputBindingDescription{
                     .inputRate = vulkanite::renderer::VertexInputRate::PER_INSTANCE,
                     .binding = 1,
-                    .strideBytes = sizeof(TileInstance),
+                    .strideBytes = sizeof(TileTransform),
+                },
+                vulkanite::renderer::VertexInputBindingDescription{
+                    .inputRate = vulkanite::renderer::VertexInputRate::PER_INSTANCE,
+                    .binding = 2,
+                    .strideBytes = sizeof(std::uint32_t),
                 },
             },
             .attributes = {
@@ -791,46 +867,22 @@ void engine::Engine::createBasicPipelineResources() {
                 },
                 // === POSITION ===
                 vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
+                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32B32_SINT,
                     .binding = 1,
                     .location = 1,
                 },
                 // === SCALE ===
                 vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
+                    .format = vulkanite::renderer::VertexAttributeFormat::R32_UINT,
                     .binding = 1,
                     .location = 2,
                 },
-                // === TEXTURE POSITION ===
+                // === PALETTE INDEX ===
                 vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
-                    .binding = 1,
+                    .format = vulkanite::renderer::VertexAttributeFormat::R32_UINT,
+                    .binding = 2,
                     .location = 3,
                 },
-                // === TEXTURE EXTENT ===
-                vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
-                    .binding = 1,
-                    .location = 4,
-                },
-                // === TEXTURE OFFSET ===
-                vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
-                    .binding = 1,
-                    .location = 5,
-                },
-                // === TEXTURE REPEAT ===
-                vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32_FLOAT,
-                    .binding = 1,
-                    .location = 6,
-                },
-                // === COLOUR FACTOR ===
-                vulkanite::renderer::VertexAttributeDescription{
-                    .format = vulkanite::renderer::VertexAttributeFormat::R32G32B32A32_FLOAT,
-                    .binding = 1,
-                    .location = 7,
-                },
             },
         },
         .inputAssembly = {
@@ -0,0 +1,139 @@
+#include <engine/paletted_voxels.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+engine::PalettedVoxels::PalettedVoxels(std::size_t count, std::uint8_t value)
+    : count_(static_cast<std::uint32_t>(count)), uniform_(value) {
+}
+
+std::uint32_t engine::PalettedVoxels::getBitsForPalette(std::size_t paletteSize) {
+    if (paletteSize <= 1) {
+        return 0;
+    }
+
+    if (paletteSize <= 2) {
+        return 1;
+    }
+
+    if (paletteSize <= 4) {
+        return 2;
+    }
+
+    if (paletteSize <= 16) {
+        return 4;
+    }
+
+    return 8;
+}
+
+void engine::PalettedVoxels::set(std::size_t index, std::uint8_t value) {
+    const std::span<const std::uint8_t> palette = getPalette();
+    const auto entry = std::ranges::find(palette, value);
+
+    if (entry != palette.end() && bits_ == 0) {
+        return;
+    }
+
+    // A value new to the palette can change the index width, so the container is
+    // repacked. That happens at most once per distinct value
+    if (entry == palette.end()) {
+        std::vector<std::uint8_t> values(count_);
+
+        unpack(values);
+        values[index] = value;
+        pack(values);
+
+        return;
+    }
+
+    const std::uint64_t paletteIndex = static_cast<std::uint64_t>(entry - palette.begin());
+    const std::uint64_t mask = (std::uint64_t{1} << bits_) - 1;
+    const std::size_t bit = index * bits_;
+
+    std::uint64_t& word = words_[getPaletteWords() + (bit >> 6)];
+
+    word = (word & ~(mask << (bit & 63))) | (paletteIndex << (bit & 63));
+}
+
+void engine::PalettedVoxels::fill(std::uint8_t value) {
+    words_.clear();
+    words_.shrink_to_fit();
+
+    paletteSize_ = 1;
+    bits_ = 0;
+    uniform_ = value;
+}
+
+void engine::PalettedVoxels::pack(std::span<const std::uint8_t> values) {
+    count_ = static_cast<std::uint32_t>(values.size());
+
+    std::array<bool, 256> present = {};
+
+    for (const std::uint8_t value : values) {
+        present[value] = true;
+    }
+
+    std::array<std::uint8_t, 256> palette = {};
+    std::array<std::uint8_t, 256> indices = {};
+
+    std::size_t paletteSize = 0;
+
+    for (std::size_t value = 0; value < present.size(); value++) {
+        if (present[value]) {
+            indices[value] = static_cast<std::uint8_t>(paletteSize);
+            palette[paletteSize++] = static_cast<std::uint8_t>(value);
+        }
+    }
+
+    if (paletteSize <= 1) {
+        fill(palette[0]);
+        return;
+    }
+
+    paletteSize_ = static_cast<std::uint16_t>(paletteSize);
+    bits_ = static_cast<std::uint8_t>(getBitsForPalette(paletteSize));
+
+    const std::size_t perWord = 64 / bits_;
+    const std::size_t paletteWords = getPaletteWords();
+
+    words_.assign(paletteWords + (count_ + perWord - 1) / perWord, 0);
+    words_.shrink_to_fit();
+
+    std::memcpy(words_.data(), palette.data(), paletteSize);
+
+    for (std::size_t first = 0, word = paletteWords; first < count_; first += perWord, word++) {
+        const std::size_t last = std::min(first + perWord, static_cast<std::size_t>(count_));
+
+        std::uint64_t packed = 0;
+
+        for (std::size_t i = first; i < last; i++) {
+            packed |= static_cast<std::uint64_t>(indices[values[i]]) << ((i - first) * bits_);
+        }
+
+        words_[word] = packed;
+    }
+}
+
+void engine::PalettedVoxels::unpack(std::span<std::uint8_t> values) const {
+    if (bits_ == 0) {
+        std::memset(values.data(), uniform_, values.size());
+        return;
+    }
+
+    const std::uint8_t* palette = getPaletteData();
+    const std::size_t perWord = 64 / bits_;
+    const std::uint64_t mask = (std::uint64_t{1} << bits_) - 1;
+
+    for (std::size_t first = 0, word = getPaletteWords(); first < values.size(); first += perWord, word++) {
+        const std::size_t last = std::min(first + perWord, values.size());
+
+        std::uint64_t packed = words_[word];
+
+        for (std::size_t i = first; i < last; i++) {
+            values[i] = palette[packed & mask];
+            packed >>= bits_;
+        }
+    }
+}
\ No newline at end of file
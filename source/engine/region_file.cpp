@@ -0,0 +1,267 @@
+#include <engine/region_file.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#if defined(ENGINE_PLATFORM_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(ENGINE_PLATFORM_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::int32_t floorDivide(std::int32_t value, std::int32_t divisor) {
+        return value / divisor - ((value % divisor != 0) && ((value < 0) != (divisor < 0)));
+    }
+
+    constexpr std::size_t TableOffset = sizeof(engine::RegionHeader);
+    constexpr std::size_t DataOffset = TableOffset + sizeof(engine::RegionSlot) * engine::RegionFile::SlotCount;
+}
+
+engine::RegionFile::RegionFile(const std::filesystem::path& path, glm::ivec3 chunkExtent)
+    : path_(path) {
+    RegionHeader header;
+
+    bool valid = false;
+
+    if (std::filesystem::exists(path_)) {
+        stream_.open(path_, std::ios::in | std::ios::out | std::ios::binary);
+
+        stream_.read(reinterpret_cast<char*>(&header), sizeof(header));
+        stream_.read(reinterpret_cast<char*>(table_.data()), sizeof(table_));
+
+        valid = stream_ && header.magic == Magic && header.version == Version && header.chunkExtent == chunkExtent;
+
+        stream_.clear();
+    }
+
+    // Regions written with another chunk size or format are started over
+    if (!valid) {
+        stream_.close();
+        stream_.open(path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+        header = {
+            .magic = Magic,
+            .version = Version,
+            .chunkExtent = chunkExtent,
+        };
+
+        table_ = {};
+
+        stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream_.write(reinterpret_cast<const char*>(table_.data()), sizeof(table_));
+        stream_.flush();
+    }
+
+    if (!stream_) {
+        throw std::runtime_error("Call failed: engine::RegionFile::RegionFile(): Region file could not be opened: " + path_.string());
+    }
+
+    stream_.seekg(0, std::ios::end);
+    fileSize_ = static_cast<std::size_t>(stream_.tellg());
+}
+
+engine::RegionFile::~RegionFile() {
+    unmap();
+}
+
+std::span<const std::uint8_t> engine::RegionFile::read(std::size_t slot) {
+    const RegionSlot& entry = table_[slot];
+
+    if (entry.size == 0) {
+        return {};
+    }
+
+    const std::size_t end = static_cast<std::size_t>(entry.offset) + entry.size;
+
+    if (mapping_ == nullptr || mappingSize_ < end) {
+        map();
+    }
+
+    if (entry.offset < DataOffset || mappingSize_ < end) {
+        return {};
+    }
+
+    return {mapping_ + entry.offset, entry.size};
+}
+
+void engine::RegionFile::write(std::size_t slot, std::span<const std::uint8_t> record) {
+    // The mapping is dropped rather than kept coherent with the file, the next read
+    // maps the grown file again
+    unmap();
+
+    const RegionSlot entry = {
+        .offset = static_cast<std::uint32_t>(fileSize_),
+        .size = static_cast<std::uint32_t>(record.size()),
+    };
+
+    // The record goes in before the table points at it, so an interrupted write only
+    // leaves unreferenced bytes behind
+    stream_.seekp(static_cast<std::streamoff>(fileSize_));
+    stream_.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(record.size()));
+
+    stream_.seekp(static_cast<std::streamoff>(TableOffset + slot * sizeof(RegionSlot)));
+    stream_.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    stream_.flush();
+
+    if (!stream_) {
+        throw std::runtime_error("Call failed: engine::RegionFile::write(): Region file could not be written: " + path_.string());
+    }
+
+    table_[slot] = entry;
+    fileSize_ += record.size();
+}
+
+void engine::RegionFile::map() {
+    unmap();
+
+#if defined(ENGINE_PLATFORM_WIN32)
+    HANDLE file = CreateFileW(path_.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Call failed: engine::RegionFile::map(): Region file could not be opened: " + path_.string());
+    }
+
+    LARGE_INTEGER size;
+
+    GetFileSizeEx(file, &size);
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping != nullptr) {
+        mapping_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+
+    if (mapping_ == nullptr) {
+        throw std::runtime_error("Call failed: engine::RegionFile::map(): Region file could not be mapped: " + path_.string());
+    }
+
+    mappingSize_ = static_cast<std::size_t>(size.QuadPart);
+#elif defined(ENGINE_PLATFORM_UNIX)
+    const int file = ::open(path_.c_str(), O_RDONLY);
+
+    if (file < 0) {
+        throw std::runtime_error("Call failed: engine::RegionFile::map(): Region file could not be opened: " + path_.string());
+    }
+
+    struct stat status;
+
+    fstat(file, &status);
+
+    const std::size_t size = static_cast<std::size_t>(status.st_size);
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    ::close(file);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Call failed: engine::RegionFile::map(): Region file could not be mapped: " + path_.string());
+    }
+
+    mapping_ = static_cast<const std::uint8_t*>(mapping);
+    mappingSize_ = size;
+#endif
+}
+
+void engine::RegionFile::unmap() {
+    if (mapping_ == nullptr) {
+        return;
+    }
+
+#if defined(ENGINE_PLATFORM_WIN32)
+    UnmapViewOfFile(mapping_);
+#elif defined(ENGINE_PLATFORM_UNIX)
+    munmap(const_cast<std::uint8_t*>(mapping_), mappingSize_);
+#endif
+
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+}
+
+void engine::RegionCache::open(const std::filesystem::path& directory, glm::ivec3 chunkExtent) {
+    close();
+
+    std::filesystem::create_directories(directory);
+
+    directory_ = directory;
+    chunkExtent_ = chunkExtent;
+    open_ = true;
+}
+
+void engine::RegionCache::close() {
+    regions_.clear();
+    entries_.clear();
+
+    open_ = false;
+}
+
+void engine::RegionCache::trim() {
+    while (regions_.size() > MaxOpenRegions) {
+        regions_.erase(entries_.back().region);
+        entries_.pop_back();
+    }
+}
+
+std::span<const std::uint8_t> engine::RegionCache::find(glm::ivec3 position) {
+    if (!open_) {
+        return {};
+    }
+
+    std::size_t slot = 0;
+
+    return getRegion(position, slot).read(slot);
+}
+
+void engine::RegionCache::store(glm::ivec3 position, std::span<const std::uint8_t> record) {
+    if (!open_) {
+        return;
+    }
+
+    std::size_t slot = 0;
+
+    getRegion(position, slot).write(slot, record);
+}
+
+engine::RegionFile& engine::RegionCache::getRegion(glm::ivec3 position, std::size_t& slot) {
+    constexpr std::int32_t extent = RegionFile::RegionExtent;
+
+    const glm::ivec3 chunk = {
+        floorDivide(position.x, chunkExtent_.x),
+        floorDivide(position.y, chunkExtent_.y),
+        floorDivide(position.z, chunkExtent_.z),
+    };
+
+    const glm::ivec3 region = {
+        floorDivide(chunk.x, extent),
+        floorDivide(chunk.y, extent),
+        floorDivide(chunk.z, extent),
+    };
+
+    const glm::ivec3 local = chunk - region * extent;
+
+    slot = static_cast<std::size_t>((local.y * extent + local.z) * extent + local.x);
+
+    if (auto iterator = regions_.find(region); iterator != regions_.end()) {
+        entries_.splice(entries_.begin(), entries_, iterator->second);
+
+        return *iterator->second->file;
+    }
+
+    entries_.push_front({
+        .region = region,
+        .file = std::make_unique<RegionFile>(directory_ / ("r." + std::to_string(region.x) + "." + std::to_string(region.y) + "." + std::to_string(region.z) + ".region"), chunkExtent_),
+    });
+
+    regions_[region] = entries_.begin();
+
+    return *entries_.front().file;
+}
\ No newline at end of file
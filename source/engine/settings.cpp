@@ -2,6 +2,7 @@
 
 #include <vulkanite/window/configuration.hpp>
 
+#include <filesystem>
 #include <fstream>
 
 #include <nlohmann/json.hpp>
@@ -13,19 +14,36 @@ engine::Settings engine::Settings::load() {
 
     if (!file) {
         save(settings);
+        return settings;
     }
 
     std::string contents(std::istreambuf_iterator<char>(file), {});
     nlohmann::json json = nlohmann::json::parse(contents);
 
-    settings.display.size.x = json["display"]["width"].get<std::uint32_t>();
-    settings.display.size.y = json["display"]["height"].get<std::uint32_t>();
+    // Missing keys keep their defaults, so settings files written before a key existed
+    // still load
+    const nlohmann::json display = json.value("display", nlohmann::json::object());
+    const nlohmann::json graphics = json.value("graphics", nlohmann::json::object());
+    const nlohmann::json performance = json.value("performance", nlohmann::json::object());
+    const nlohmann::json world = json.value("world", nlohmann::json::object());
 
-    settings.graphics.imageCount = json["graphics"]["imageCount"].get<std::uint32_t>();
-    settings.graphics.renderAheadLimit = json["graphics"]["renderAheadLimit"].get<std::uint32_t>();
-    settings.graphics.vsync = json["graphics"]["vsync"].get<bool>();
+    settings.display.size.x = display.value("width", settings.display.size.x);
+    settings.display.size.y = display.value("height", settings.display.size.y);
 
-    std::string displayMode = json["display"]["mode"].get<std::string>();
+    settings.graphics.imageCount = graphics.value("imageCount", settings.graphics.imageCount);
+    settings.graphics.renderAheadLimit = graphics.value("renderAheadLimit", settings.graphics.renderAheadLimit);
+    settings.graphics.vsync = graphics.value("vsync", settings.graphics.vsync);
+
+    settings.performance.workerThreads = performance.value("workerThreads", settings.performance.workerThreads);
+
+    settings.world.regionDirectory = world.value("regionDirectory", settings.world.regionDirectory);
+    settings.world.residencyBudget = world.value("residencyBudget", settings.world.residencyBudget);
+    settings.world.unloadMargin = world.value("unloadMargin", settings.world.unloadMargin);
+    settings.world.streamBudget = world.value("streamBudget", settings.world.streamBudget);
+    settings.world.prefetchTime = world.value("prefetchTime", settings.world.prefetchTime);
+    settings.world.unloadBudget = world.value("unloadBudget", settings.world.unloadBudget);
+
+    std::string displayMode = display.value("mode", std::string(settings.display.mode == vulkanite::window::Visibility::FULLSCREEN ? "fullscreen" : "windowed"));
 
     if (displayMode == "windowed") {
         settings.display.mode = vulkanite::window::Visibility::WINDOWED;
@@ -51,6 +69,17 @@ void engine::Settings::save(const Settings& settings) {
     json["graphics"]["renderAheadLimit"] = settings.graphics.renderAheadLimit;
     json["graphics"]["vsync"] = settings.graphics.vsync;
 
+    json["performance"]["workerThreads"] = settings.performance.workerThreads;
+
+    json["world"]["regionDirectory"] = settings.world.regionDirectory;
+    json["world"]["residencyBudget"] = settings.world.residencyBudget;
+    json["world"]["unloadMargin"] = settings.world.unloadMargin;
+    json["world"]["streamBudget"] = settings.world.streamBudget;
+    json["world"]["prefetchTime"] = settings.world.prefetchTime;
+    json["world"]["unloadBudget"] = settings.world.unloadBudget;
+
+    std::filesystem::create_directories("config");
+
     std::ofstream file("config/settings.json", std::ios::trunc);
 
     if (!file) {
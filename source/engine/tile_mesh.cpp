@@ -24,8 +24,12 @@ engine::TileMesh::~TileMesh() {
         meshBuffer_.destroy();
     }
 
-    if (instanceBuffer_) {
-        instanceBuffer_.destroy();
+    if (transformBuffer_) {
+        transformBuffer_.destroy();
+    }
+
+    if (paletteIndexBuffer_) {
+        paletteIndexBuffer_.destroy();
     }
 }
 
@@ -53,42 +57,88 @@ void engine::TileMesh::setBaseMesh(const std::array<glm::vec2, 4>& vertices) {
 }
 
 void engine::TileMesh::createInstanceBuffer(std::size_t instanceCount) {
-    if (instanceBuffer_) {
-        instanceBuffer_.destroy();
+    if (transformBuffer_) {
+        transformBuffer_.destroy();
+    }
+
+    if (paletteIndexBuffer_) {
+        paletteIndexBuffer_.destroy();
     }
 
     auto& renderer = engine_->getRenderer();
     auto& device = renderer.getDevice();
 
-    vulkanite::renderer::BufferCreateInfo createInfo = {
+    vulkanite::renderer::BufferCreateInfo transformCreateInfo = {
+        .device = device,
+        .memoryType = vulkanite::renderer::MemoryType::DEVICE_LOCAL,
+        .usageFlags = vulkanite::renderer::BufferUsageFlags::VERTEX | vulkanite::renderer::BufferUsageFlags::TRANSFER_DESTINATION,
+        .sizeBytes = instanceCount * sizeof(TileTransform),
+    };
+
+    vulkanite::renderer::BufferCreateInfo paletteIndexCreateInfo = {
         .device = device,
         .memoryType = vulkanite::renderer::MemoryType::DEVICE_LOCAL,
         .usageFlags = vulkanite::renderer::BufferUsageFlags::VERTEX | vulkanite::renderer::BufferUsageFlags::TRANSFER_DESTINATION,
-        .sizeBytes = instanceCount * sizeof(TileInstance),
+        .sizeBytes = instanceCount * sizeof(std::uint32_t),
     };
 
-    instanceBuffer_.create(createInfo);
+    transformBuffer_.create(transformCreateInfo);
+    paletteIndexBuffer_.create(paletteIndexCreateInfo);
+}
+
+void engine::TileMesh::setTransforms(std::span<const TileTransform> transforms, std::span<const TileRange> ranges) {
+    instanceCount_ = transforms.size();
+
+    uploadRanges(transformBuffer_, transforms.data(), sizeof(TileTransform), ranges);
+}
+
+void engine::TileMesh::setPaletteIndices(std::span<const std::uint32_t> paletteIndices, std::span<const TileRange> ranges) {
+    uploadRanges(paletteIndexBuffer_, paletteIndices.data(), sizeof(std::uint32_t), ranges);
+}
+
+void engine::TileMesh::setDrawRanges(std::span<const TileRange> ranges) {
+    drawRanges_.assign(ranges.begin(), ranges.end());
 }
 
-void engine::TileMesh::setInstances(std::span<TileInstance> instances) {
+void engine::TileMesh::uploadRanges(vulkanite::renderer::Buffer& buffer, const void* data, std::size_t stride, std::span<const TileRange> ranges) {
+    if (ranges.empty()) {
+        return;
+    }
+
     auto& stagingManager = engine_->getStagingManager();
     auto& transferBuffer = engine_->getTransferBuffer();
     auto& stagingBuffer = stagingManager.getCurrentBuffer();
     auto& stagingOffset = stagingManager.getOffset();
 
-    auto mapping = stagingBuffer.map(sizeof(TileInstance) * instances.size(), stagingOffset);
+    std::size_t totalSize = 0;
 
-    std::memcpy(mapping.data.data(), instances.data(), sizeof(TileInstance) * instances.size());
+    for (const TileRange& range : ranges) {
+        totalSize += stride * (range.end - range.begin);
+    }
 
-    stagingBuffer.unmap(mapping);
+    auto mapping = stagingBuffer.map(totalSize, stagingOffset);
 
-    vulkanite::renderer::BufferCopyRegion copyRegion = {
-        .sourceOffsetBytes = stagingOffset,
-        .destinationOffsetBytes = 0,
-        .sizeBytes = sizeof(TileInstance) * instances.size(),
-    };
+    copyRegions_.clear();
+
+    std::size_t mappingOffset = 0;
+
+    for (const TileRange& range : ranges) {
+        const std::size_t sizeBytes = stride * (range.end - range.begin);
+
+        std::memcpy(mapping.data.data() + mappingOffset, static_cast<const std::byte*>(data) + stride * range.begin, sizeBytes);
+
+        copyRegions_.push_back({
+            .sourceOffsetBytes = stagingOffset + mappingOffset,
+            .destinationOffsetBytes = stride * range.begin,
+            .sizeBytes = sizeBytes,
+        });
+
+        mappingOffset += sizeBytes;
+    }
+
+    stagingBuffer.unmap(mapping);
 
-    transferBuffer.copyBuffer(stagingBuffer, instanceBuffer_, {copyRegion});
+    transferBuffer.copyBuffer(stagingBuffer, buffer, copyRegions_);
 
-    stagingOffset += sizeof(TileInstance) * instances.size();
+    stagingOffset += totalSize;
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include <engine/engine.hpp>
+#include <engine/tile_palette.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+engine::TilePalette::~TilePalette() {
+    if (buffer_) {
+        buffer_.destroy();
+    }
+}
+
+void engine::TilePalette::create(Engine& engine) {
+    engine_ = &engine;
+
+    auto& renderer = engine_->getRenderer();
+    auto& device = renderer.getDevice();
+
+    vulkanite::renderer::BufferCreateInfo bufferCreateInfo = {
+        .device = device,
+        .memoryType = vulkanite::renderer::MemoryType::DEVICE_LOCAL,
+        .usageFlags = vulkanite::renderer::BufferUsageFlags::UNIFORM | vulkanite::renderer::BufferUsageFlags::TRANSFER_DESTINATION,
+        .sizeBytes = sizeof(entries_),
+    };
+
+    buffer_.create(bufferCreateInfo);
+}
+
+void engine::TilePalette::set(std::uint32_t index, const TileAppearance& appearance) {
+    entries_[index] = appearance;
+
+    dirtyBegin_ = std::min(dirtyBegin_, index);
+    dirtyEnd_ = std::max(dirtyEnd_, index + 1);
+}
+
+std::uint32_t engine::TilePalette::allocateOverride(const TileAppearance& appearance) {
+    std::uint32_t index;
+
+    if (!freedOverrides_.empty()) {
+        index = freedOverrides_.back();
+        freedOverrides_.pop_back();
+    }
+    else if (nextOverride_ < Capacity) {
+        index = nextOverride_++;
+    }
+    else {
+        throw std::runtime_error("Call failed: engine::TilePalette::allocateOverride(): No override entries left");
+    }
+
+    set(index, appearance);
+
+    return index;
+}
+
+void engine::TilePalette::releaseOverride(std::uint32_t index) {
+    // A slot released twice would be handed to two owners, so only live overrides go back
+    if (index < TileCount || index >= nextOverride_ || std::ranges::find(freedOverrides_, index) != freedOverrides_.end()) {
+        return;
+    }
+
+    freedOverrides_.push_back(index);
+}
+
+void engine::TilePalette::upload() {
+    if (dirtyBegin_ >= dirtyEnd_) {
+        return;
+    }
+
+    auto& stagingManager = engine_->getStagingManager();
+    auto& transferBuffer = engine_->getTransferBuffer();
+    auto& stagingBuffer = stagingManager.getCurrentBuffer();
+    auto& stagingOffset = stagingManager.getOffset();
+
+    const std::size_t sizeBytes = sizeof(TileAppearance) * (dirtyEnd_ - dirtyBegin_);
+
+    auto mapping = stagingBuffer.map(sizeBytes, stagingOffset);
+
+    std::memcpy(mapping.data.data(), entries_.data() + dirtyBegin_, sizeBytes);
+
+    stagingBuffer.unmap(mapping);
+
+    vulkanite::renderer::BufferCopyRegion copyRegion = {
+        .sourceOffsetBytes = stagingOffset,
+        .destinationOffsetBytes = sizeof(TileAppearance) * dirtyBegin_,
+        .sizeBytes = sizeBytes,
+    };
+
+    transferBuffer.copyBuffer(stagingBuffer, buffer_, {copyRegion});
+
+    stagingOffset += sizeBytes;
+
+    dirtyBegin_ = Capacity;
+    dirtyEnd_ = 0;
+}
\ No newline at end of file
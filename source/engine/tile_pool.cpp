@@ -1,7 +1,119 @@
 #include <engine/tile_pool.hpp>
+#include <engine/worker_pool.hpp>
 
 #include <algorithm>
-#include <numeric>
+#include <stdexcept>
+
+glm::ivec3 engine::packTilePosition(glm::vec3 position) {
+    return glm::ivec3(glm::round(position * static_cast<float>(TileSubdivisions)));
+}
+
+glm::vec3 engine::unpackTilePosition(glm::ivec3 position) {
+    return glm::vec3(position) / static_cast<float>(TileSubdivisions);
+}
+
+std::uint32_t engine::packTileScale(glm::vec2 scale) {
+    const glm::vec2 clamped = glm::clamp(glm::round(scale * static_cast<float>(TileSubdivisions)), glm::vec2(0.0f), glm::vec2(65535.0f));
+
+    return static_cast<std::uint32_t>(clamped.x) | (static_cast<std::uint32_t>(clamped.y) << 16);
+}
+
+glm::vec2 engine::unpackTileScale(std::uint32_t scale) {
+    return glm::vec2(static_cast<float>(scale & 0xFFFF), static_cast<float>(scale >> 16)) / static_cast<float>(TileSubdivisions);
+}
+
+void engine::TileRangeSet::mark(std::size_t begin, std::size_t end) {
+    if (!ranges_.empty()) {
+        auto& last = ranges_.back();
+
+        if (begin <= last.end + MergeDistance && end + MergeDistance >= last.begin) {
+            last.begin = std::min(last.begin, begin);
+            last.end = std::max(last.end, end);
+            return;
+        }
+    }
+
+    ranges_.push_back({begin, end});
+
+    if (ranges_.size() < CoalesceThreshold) {
+        return;
+    }
+
+    coalesce(std::numeric_limits<std::size_t>::max());
+
+    if (ranges_.size() >= CoalesceThreshold / 2) {
+        closeGaps(CoalesceThreshold / 4);
+    }
+}
+
+void engine::TileRangeSet::clear() {
+    ranges_.clear();
+}
+
+std::span<const engine::TileRange> engine::TileRangeSet::get(std::size_t size) {
+    coalesce(size);
+
+    return ranges_;
+}
+
+// Bridges the narrowest gaps between sorted ranges until at most count are left, so
+// an overflowing set only grows by the cheapest filler instead of spanning everything
+void engine::TileRangeSet::closeGaps(std::size_t count) {
+    if (ranges_.size() <= count) {
+        return;
+    }
+
+    gapScratch_.clear();
+
+    for (std::size_t i = 1; i < ranges_.size(); i++) {
+        gapScratch_.push_back(ranges_[i].begin - ranges_[i - 1].end);
+    }
+
+    const auto widest = gapScratch_.begin() + static_cast<std::ptrdiff_t>(ranges_.size() - count - 1);
+
+    std::ranges::nth_element(gapScratch_, widest);
+
+    const std::size_t limit = *widest;
+
+    std::size_t kept = 0;
+
+    for (const TileRange& range : ranges_) {
+        if (kept != 0 && range.begin - ranges_[kept - 1].end <= limit) {
+            ranges_[kept - 1].end = range.end;
+        }
+        else {
+            ranges_[kept++] = range;
+        }
+    }
+
+    ranges_.resize(kept);
+}
+
+void engine::TileRangeSet::coalesce(std::size_t size) {
+    std::ranges::sort(ranges_, {}, &TileRange::begin);
+
+    std::size_t count = 0;
+
+    for (const TileRange& range : ranges_) {
+        const TileRange clamped = {
+            .begin = range.begin,
+            .end = std::min(range.end, size),
+        };
+
+        if (clamped.begin >= clamped.end) {
+            continue;
+        }
+
+        if (count != 0 && clamped.begin <= ranges_[count - 1].end + MergeDistance) {
+            ranges_[count - 1].end = std::max(ranges_[count - 1].end, clamped.end);
+        }
+        else {
+            ranges_[count++] = clamped;
+        }
+    }
+
+    ranges_.resize(count);
+}
 
 std::uint32_t engine::TilePool::maxIdentifier_ = 0;
 
@@ -22,9 +134,10 @@ components::TileProxy engine::TilePool::insert(const TileInstance& base, std::in
         table_.push_back(DeadIndex);
     }
 
-    const std::size_t denseIndex = instances_.size();
+    const std::size_t denseIndex = data_.size();
 
-    instances_.emplace_back(base);
+    transforms_.emplace_back(base.transform);
+    paletteIndices_.emplace_back(base.paletteIndex);
     data_.emplace_back(order);
 
     if (reverse_.size() <= denseIndex)
@@ -33,20 +146,133 @@ components::TileProxy engine::TilePool::insert(const TileInstance& base, std::in
     table_[proxyIndex] = denseIndex;
     reverse_[denseIndex] = proxyIndex;
 
+    markDirty(denseIndex, denseIndex + 1);
+
+    version_++;
+    snapshotStale_ = true;
+
     return {
         .index = proxyIndex,
         .uniqueIdentifier = identifier_,
     };
 }
 
-engine::TileInstance& engine::TilePool::getInstance(components::TileProxy proxy) {
-    return instances_[table_[proxy.index]];
+std::span<const components::TileProxy> engine::TilePool::insertBatch(std::span<const TileInstance> bases, std::span<const std::int64_t> orders, std::uint32_t group) {
+    if (bases.size() != orders.size()) {
+        throw std::runtime_error("Call failed: engine::TilePool::insertBatch(): Instance and order counts differ");
+    }
+
+    const std::size_t count = bases.size();
+    const std::size_t first = data_.size();
+
+    proxyScratch_.resize(count);
+
+    if (count == 0) {
+        return proxyScratch_;
+    }
+
+    transforms_.resize(first + count);
+    paletteIndices_.resize(first + count);
+    data_.resize(first + count);
+    reverse_.resize(first + count);
+
+    const std::size_t reused = std::min(count, freed_.size());
+
+    for (std::size_t i = 0; i < reused; i++) {
+        proxyScratch_[i].index = freed_[freed_.size() - 1 - i];
+    }
+
+    freed_.resize(freed_.size() - reused);
+
+    const std::size_t fresh = table_.size();
+
+    table_.resize(fresh + count - reused);
+
+    for (std::size_t i = reused; i < count; i++) {
+        proxyScratch_[i].index = fresh + i - reused;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        const std::size_t denseIndex = first + i;
+        const std::size_t proxyIndex = proxyScratch_[i].index;
+
+        transforms_[denseIndex] = bases[i].transform;
+        paletteIndices_[denseIndex] = bases[i].paletteIndex;
+        data_[denseIndex] = {
+            .order = orders[i],
+            .group = group,
+        };
+
+        table_[proxyIndex] = denseIndex;
+        reverse_[denseIndex] = proxyIndex;
+
+        proxyScratch_[i].uniqueIdentifier = identifier_;
+    }
+
+    markDirty(first, first + count);
+
+    if (group != NoTileGroup && !groupsStale_) {
+        auto& entry = groupTable_[group];
+
+        entry.range = {
+            .begin = entry.count == 0 ? first : std::min(entry.range.begin, first),
+            .end = first + count,
+        };
+
+        entry.count += count;
+    }
+
+    version_++;
+    snapshotStale_ = true;
+
+    return proxyScratch_;
+}
+
+engine::TileTransform& engine::TilePool::getTransform(components::TileProxy proxy) {
+    const std::size_t denseIndex = table_[proxy.index];
+
+    transformRanges_.mark(denseIndex, denseIndex + 1);
+
+    return transforms_[denseIndex];
+}
+
+const engine::TileTransform& engine::TilePool::getTransform(components::TileProxy proxy) const {
+    return transforms_[table_[proxy.index]];
+}
+
+std::uint32_t& engine::TilePool::getPaletteIndex(components::TileProxy proxy) {
+    const std::size_t denseIndex = table_[proxy.index];
+
+    paletteIndexRanges_.mark(denseIndex, denseIndex + 1);
+
+    return paletteIndices_[denseIndex];
 }
 
 engine::TileData& engine::TilePool::getData(components::TileProxy proxy) {
+    snapshotStale_ = true;
+
     return data_[table_[proxy.index]];
 }
 
+void engine::TilePool::setTransform(components::TileProxy proxy, const TileTransform& transform) {
+    const std::size_t denseIndex = table_[proxy.index];
+    auto& current = transforms_[denseIndex];
+
+    if (current.position != transform.position || current.scale != transform.scale) {
+        current = transform;
+        transformRanges_.mark(denseIndex, denseIndex + 1);
+    }
+}
+
+void engine::TilePool::setOrder(components::TileProxy proxy, std::int64_t order) {
+    auto& data = data_[table_[proxy.index]];
+
+    if (data.order != order) {
+        data.order = order;
+        snapshotStale_ = true;
+    }
+}
+
 void engine::TilePool::remove(components::TileProxy proxy) {
     if (!contains(proxy)) {
         return;
@@ -54,24 +280,37 @@ void engine::TilePool::remove(components::TileProxy proxy) {
 
     const std::size_t sparseIndex = proxy.index;
     const std::size_t denseIndex = table_[sparseIndex];
-    const std::size_t lastIndex = instances_.size() - 1;
+    const std::size_t lastIndex = data_.size() - 1;
 
     if (denseIndex != lastIndex) {
-        instances_[denseIndex] = std::move(instances_.back());
-        data_[denseIndex] = std::move(data_.back());
+        transforms_[denseIndex] = transforms_.back();
+        paletteIndices_[denseIndex] = paletteIndices_.back();
+        data_[denseIndex] = data_.back();
 
         const std::size_t movedProxy = reverse_[lastIndex];
 
         table_[movedProxy] = denseIndex;
         reverse_[denseIndex] = movedProxy;
+
+        markDirty(denseIndex, denseIndex + 1);
     }
 
-    instances_.pop_back();
+    groupsStale_ = true;
+
+    transforms_.pop_back();
+    paletteIndices_.pop_back();
     data_.pop_back();
     reverse_.pop_back();
 
     table_[sparseIndex] = DeadIndex;
     freed_.push_back(sparseIndex);
+
+    version_++;
+    snapshotStale_ = true;
+
+    if (compacting_ && compactRead_ >= data_.size()) {
+        finishCompaction();
+    }
 }
 
 bool engine::TilePool::contains(components::TileProxy proxy) const {
@@ -80,48 +319,442 @@ bool engine::TilePool::contains(components::TileProxy proxy) const {
 
 void engine::TilePool::clear() {
     table_.clear();
-    instances_.clear();
+    transforms_.clear();
+    paletteIndices_.clear();
     data_.clear();
+    clearDirtyRanges();
+
+    groupTable_.clear();
+    freedGroups_.clear();
+    releasedGroupCount_ = 0;
+    compacting_ = false;
+
+    version_++;
+    snapshotStale_ = true;
 }
 
-void engine::TilePool::sortByDepth() {
-    const std::size_t n = instances_.size();
+template <typename Source>
+void engine::TilePool::reorder(std::size_t begin, std::size_t end, Source source) {
+    if (begin >= end) {
+        return;
+    }
+
+    const std::size_t count = end - begin;
 
-    if (n <= 1) {
+    transformScratch_.resize(count);
+    paletteIndexScratch_.resize(count);
+    dataScratch_.resize(count);
+    reverseScratch_.resize(count);
+
+    parallelFor(workerPool_, count, TileSorter::ParallelGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::size_t index = source(begin + i);
+
+            transformScratch_[i] = transforms_[index];
+            paletteIndexScratch_[i] = paletteIndices_[index];
+            dataScratch_[i] = data_[index];
+            reverseScratch_[i] = reverse_[index];
+        }
+    });
+
+    if (count == data_.size()) {
+        transforms_.swap(transformScratch_);
+        paletteIndices_.swap(paletteIndexScratch_);
+        data_.swap(dataScratch_);
+        reverse_.swap(reverseScratch_);
+    }
+    else {
+        parallelFor(workerPool_, count, TileSorter::ParallelGrain, [&](std::size_t first, std::size_t last) {
+            const auto from = static_cast<std::ptrdiff_t>(first);
+            const auto to = static_cast<std::ptrdiff_t>(last);
+            const auto offset = static_cast<std::ptrdiff_t>(begin);
+
+            std::copy(transformScratch_.begin() + from, transformScratch_.begin() + to, transforms_.begin() + offset + from);
+            std::copy(paletteIndexScratch_.begin() + from, paletteIndexScratch_.begin() + to, paletteIndices_.begin() + offset + from);
+            std::copy(dataScratch_.begin() + from, dataScratch_.begin() + to, data_.begin() + offset + from);
+            std::copy(reverseScratch_.begin() + from, reverseScratch_.begin() + to, reverse_.begin() + offset + from);
+        });
+    }
+
+    parallelFor(workerPool_, count, TileSorter::ParallelGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = begin + first; i < begin + last; ++i) {
+            table_[reverse_[i]] = i;
+        }
+    });
+
+    markDirty(begin, end);
+
+    groupsStale_ = true;
+}
+
+bool engine::TilePool::sortByDepth() {
+    if (compacting_) {
+        return false;
+    }
+
+    const TileOrdering ordering = sorter_.sort(data_);
+
+    reorder(ordering.begin, ordering.end, [&](std::size_t i) {
+        return static_cast<std::size_t>(ordering.permutation[i]);
+    });
+
+    return true;
+}
+
+bool engine::TilePool::captureSnapshot() {
+    if (!snapshotStale_ || compacting_) {
+        return false;
+    }
+
+    snapshot_.data.assign(data_.begin(), data_.end());
+    snapshot_.proxies.assign(reverse_.begin(), reverse_.begin() + static_cast<std::ptrdiff_t>(data_.size()));
+    snapshot_.version = version_;
+
+    snapshotStale_ = false;
+    snapshotPending_ = true;
+
+    return true;
+}
+
+void engine::TilePool::sortSnapshot() {
+    if (!snapshotPending_) {
+        return;
+    }
+
+    snapshotPending_ = false;
+
+    const TileOrdering ordering = snapshotSorter_.sort(snapshot_.data);
+
+    if (ordering.empty()) {
         return;
     }
 
-    std::vector<std::size_t> order(n);
+    auto& result = orderings_.back();
 
-    std::iota(order.begin(), order.end(), 0);
+    result.proxies.assign(snapshot_.proxies.begin(), snapshot_.proxies.end());
+    result.begin = ordering.begin;
+    result.end = ordering.end;
+    result.version = snapshot_.version;
 
-    std::ranges::sort(order, [&](std::size_t a, std::size_t b) {
-        return data_[a].order > data_[b].order;
+    parallelFor(workerPool_, ordering.end - ordering.begin, TileSorter::ParallelGrain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = ordering.begin + first; i < ordering.begin + last; i++) {
+            result.proxies[i] = snapshot_.proxies[ordering.permutation[i]];
+        }
     });
 
-    std::vector<TileInstance> newInstances(n);
-    std::vector<TileData> newData(n);
-    std::vector<std::size_t> newReverse(n);
+    orderings_.publish();
+}
+
+bool engine::TilePool::applyOrdering() {
+    if (compacting_ || !orderings_.update()) {
+        return false;
+    }
+
+    const auto& ordering = orderings_.front();
 
-    for (std::size_t i = 0; i < n; ++i) {
-        newInstances[i] = std::move(instances_[order[i]]);
-        newData[i] = std::move(data_[order[i]]);
+    if (ordering.version == version_) {
+        reorder(ordering.begin, ordering.end, [&](std::size_t i) {
+            return table_[ordering.proxies[i]];
+        });
+
+        return true;
+    }
 
-        const std::size_t sparseIndex = reverse_[order[i]];
+    // Tiles were inserted or removed since the snapshot was taken. Keep the sorted
+    // order of the survivors and leave anything newer at the back for the next sort
+    placedScratch_.assign(table_.size(), 0);
+    orderScratch_.clear();
+
+    for (const std::size_t proxy : ordering.proxies) {
+        if (proxy < table_.size() && table_[proxy] != DeadIndex && !placedScratch_[proxy]) {
+            placedScratch_[proxy] = 1;
+            orderScratch_.push_back(proxy);
+        }
+    }
+
+    for (std::size_t i = 0; i < data_.size(); i++) {
+        if (!placedScratch_[reverse_[i]]) {
+            orderScratch_.push_back(reverse_[i]);
+        }
+    }
+
+    std::size_t begin = 0;
+    std::size_t end = orderScratch_.size();
+
+    while (begin < end && orderScratch_[begin] == reverse_[begin]) {
+        begin++;
+    }
 
-        newReverse[i] = sparseIndex;
-        table_[sparseIndex] = i;
+    while (end > begin && orderScratch_[end - 1] == reverse_[end - 1]) {
+        end--;
     }
 
-    instances_ = std::move(newInstances);
-    data_ = std::move(newData);
-    reverse_ = std::move(newReverse);
+    reorder(begin, end, [&](std::size_t i) {
+        return table_[orderScratch_[i]];
+    });
+
+    return true;
 }
 
-std::vector<std::size_t>& engine::TilePool::getProxyGroup(std::size_t index) {
-    if (groupTable_.size() <= index) {
-        groupTable_.resize(index + 1);
+std::uint32_t engine::TilePool::createGroup() {
+    std::uint32_t group;
+
+    if (!freedGroups_.empty()) {
+        group = freedGroups_.back();
+        freedGroups_.pop_back();
+    }
+    else {
+        group = static_cast<std::uint32_t>(groupTable_.size());
+        groupTable_.emplace_back();
+    }
+
+    groupTable_[group] = {
+        .range = {},
+        .count = 0,
+        .used = true,
+        .released = false,
+    };
+
+    return group;
+}
+
+void engine::TilePool::releaseGroup(std::uint32_t group) {
+    if (group >= groupTable_.size() || !groupTable_[group].used || groupTable_[group].released) {
+        return;
+    }
+
+    groupTable_[group].released = true;
+    releasedGroupCount_++;
+}
+
+engine::TileRange engine::TilePool::getGroupRange(std::uint32_t group) {
+    if (groupsStale_) {
+        refreshGroups();
+    }
+
+    return groupTable_[group].range;
+}
+
+std::span<const engine::TileRange> engine::TilePool::getLiveRanges() {
+    liveRanges_.clear();
+
+    if (releasedGroupCount_ == 0 && !compacting_) {
+        if (!data_.empty()) {
+            liveRanges_.push_back({0, data_.size()});
+        }
+
+        return liveRanges_;
+    }
+
+    if (groupsStale_) {
+        refreshGroups();
+    }
+
+    releasedScratch_.clear();
+
+    // Tiles of other groups (or of none, like entities) can sort into the band of a
+    // released group. Its span is only hidden whole when the group fills it, otherwise
+    // just the runs of its own tiles are
+    for (std::uint32_t group = 0; group < groupTable_.size(); group++) {
+        const TileGroup& released = groupTable_[group];
+
+        if (!released.released || released.count == 0) {
+            continue;
+        }
+
+        if (released.range.end - released.range.begin == released.count) {
+            releasedScratch_.push_back(released.range);
+            continue;
+        }
+
+        for (std::size_t i = released.range.begin; i < released.range.end; i++) {
+            if (data_[i].group != group) {
+                continue;
+            }
+
+            if (!releasedScratch_.empty() && releasedScratch_.back().end == i) {
+                releasedScratch_.back().end++;
+            }
+            else {
+                releasedScratch_.push_back({i, i + 1});
+            }
+        }
+    }
+
+    const TileRange gap = getCompactionGap();
+
+    if (gap.begin < gap.end) {
+        releasedScratch_.push_back(gap);
     }
 
-    return groupTable_[index];
+    std::ranges::sort(releasedScratch_, {}, &TileRange::begin);
+
+    std::size_t begin = 0;
+
+    for (const TileRange& released : releasedScratch_) {
+        if (released.begin > begin) {
+            liveRanges_.push_back({begin, released.begin});
+        }
+
+        begin = std::max(begin, released.end);
+    }
+
+    if (begin < data_.size()) {
+        liveRanges_.push_back({begin, data_.size()});
+    }
+
+    return liveRanges_;
+}
+
+void engine::TilePool::compact(std::chrono::microseconds budget) {
+    if (!compacting_) {
+        if (releasedGroupCount_ == 0) {
+            return;
+        }
+
+        if (groupsStale_) {
+            refreshGroups();
+        }
+
+        std::size_t first = data_.size();
+
+        for (const TileGroup& group : groupTable_) {
+            if (group.released && group.count != 0) {
+                first = std::min(first, group.range.begin);
+            }
+        }
+
+        compactRead_ = first;
+        compactWrite_ = first;
+        compacting_ = true;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Until the pass reaches the end, the gap between write and read holds stale copies
+    // of tiles that already moved down. It stays out of the live ranges and the groups
+    while (compactRead_ < data_.size()) {
+        const std::size_t begin = compactWrite_;
+        const std::size_t last = std::min(compactRead_ + CompactGrain, data_.size());
+
+        for (; compactRead_ < last; compactRead_++) {
+            const std::uint32_t group = data_[compactRead_].group;
+
+            if (group != NoTileGroup && groupTable_[group].released) {
+                table_[reverse_[compactRead_]] = DeadIndex;
+                freed_.push_back(reverse_[compactRead_]);
+                continue;
+            }
+
+            transforms_[compactWrite_] = transforms_[compactRead_];
+            paletteIndices_[compactWrite_] = paletteIndices_[compactRead_];
+            data_[compactWrite_] = data_[compactRead_];
+            reverse_[compactWrite_] = reverse_[compactRead_];
+
+            table_[reverse_[compactWrite_]] = compactWrite_;
+
+            compactWrite_++;
+        }
+
+        markDirty(begin, compactWrite_);
+
+        if (budget.count() > 0 && std::chrono::steady_clock::now() - start >= budget) {
+            break;
+        }
+    }
+
+    version_++;
+    groupsStale_ = true;
+    snapshotStale_ = true;
+
+    if (compactRead_ >= data_.size()) {
+        finishCompaction();
+    }
+}
+
+void engine::TilePool::finishCompaction() {
+    transforms_.resize(compactWrite_);
+    paletteIndices_.resize(compactWrite_);
+    data_.resize(compactWrite_);
+    reverse_.resize(compactWrite_);
+
+    compacting_ = false;
+
+    refreshGroups();
+
+    // Groups released while the pass was underway can still have tiles in front of
+    // where it started, those wait for the next pass
+    releasedGroupCount_ = 0;
+
+    for (std::uint32_t group = 0; group < groupTable_.size(); group++) {
+        if (!groupTable_[group].released) {
+            continue;
+        }
+
+        if (groupTable_[group].count == 0) {
+            groupTable_[group] = {};
+            freedGroups_.push_back(group);
+        }
+        else {
+            releasedGroupCount_++;
+        }
+    }
+}
+
+void engine::TilePool::refreshGroups() {
+    for (TileGroup& group : groupTable_) {
+        group.range = {};
+        group.count = 0;
+    }
+
+    const TileRange gap = getCompactionGap();
+
+    for (std::size_t i = 0; i < data_.size(); i++) {
+        if (i == gap.begin && gap.begin < gap.end) {
+            i = gap.end - 1;
+            continue;
+        }
+
+        const std::uint32_t group = data_[i].group;
+
+        if (group == NoTileGroup) {
+            continue;
+        }
+
+        auto& entry = groupTable_[group];
+
+        if (entry.count == 0) {
+            entry.range.begin = i;
+        }
+
+        entry.range.end = i + 1;
+        entry.count++;
+    }
+
+    groupsStale_ = false;
+}
+
+void engine::TilePool::setWorkerPool(WorkerPool* workerPool) {
+    workerPool_ = workerPool;
+
+    sorter_.setWorkerPool(workerPool);
+    snapshotSorter_.setWorkerPool(workerPool);
+}
+
+void engine::TilePool::markDirty(std::size_t begin, std::size_t end) {
+    transformRanges_.mark(begin, end);
+    paletteIndexRanges_.mark(begin, end);
+}
+
+void engine::TilePool::clearDirtyRanges() {
+    transformRanges_.clear();
+    paletteIndexRanges_.clear();
+}
+
+std::span<const engine::TileRange> engine::TilePool::getDirtyTransformRanges() {
+    return transformRanges_.get(data_.size());
+}
+
+std::span<const engine::TileRange> engine::TilePool::getDirtyPaletteIndexRanges() {
+    return paletteIndexRanges_.get(data_.size());
 }
\ No newline at end of file
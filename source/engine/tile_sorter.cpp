@@ -0,0 +1,301 @@
+#include <engine/tile_pool.hpp>
+#include <engine/tile_sorter.hpp>
+#include <engine/worker_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+engine::TileOrdering engine::TileSorter::sort(std::span<const TileData> data) {
+    if (data.size() <= 1) {
+        fullRebuild_ = false;
+        return {};
+    }
+
+    computeKeys(data);
+
+    fullRebuild_ = !incrementalSort() && !mergeRuns();
+
+    if (fullRebuild_ && workerPool_ != nullptr && data.size() >= ParallelGrain * 2) {
+        parallelRadixSort();
+    }
+    else if (fullRebuild_) {
+        radixSort();
+    }
+
+    return finalise();
+}
+
+void engine::TileSorter::computeKeys(std::span<const TileData> data) {
+    keys_.resize(data.size());
+
+    // Tiles are drawn in descending order, so flip the sign bit to get an unsigned
+    // ordering and invert it so that ascending keys give descending orders
+    parallelFor(workerPool_, data.size(), ParallelGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            keys_[i] = ~(static_cast<std::uint64_t>(data[i].order) ^ (std::uint64_t{1} << 63));
+        }
+    });
+}
+
+void engine::TileSorter::radixSort() {
+    constexpr std::size_t passCount = sizeof(std::uint64_t);
+    constexpr std::size_t bucketCount = 256;
+
+    const std::size_t count = keys_.size();
+
+    std::array<std::array<std::uint32_t, bucketCount>, passCount> histograms = {};
+
+    for (const std::uint64_t key : keys_) {
+        for (std::size_t pass = 0; pass < passCount; pass++) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    permutation_.resize(count);
+    permutationScratch_.resize(count);
+    keyScratch_.resize(count);
+
+    std::iota(permutation_.begin(), permutation_.end(), 0);
+
+    for (std::size_t pass = 0; pass < passCount; pass++) {
+        auto& histogram = histograms[pass];
+        const std::size_t shift = pass * 8;
+
+        if (histogram[(keys_[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        std::uint32_t offset = 0;
+
+        for (auto& bucket : histogram) {
+            const std::uint32_t size = bucket;
+
+            bucket = offset;
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < count; i++) {
+            const std::uint32_t destination = histogram[(keys_[i] >> shift) & 0xFF]++;
+
+            keyScratch_[destination] = keys_[i];
+            permutationScratch_[destination] = permutation_[i];
+        }
+
+        keys_.swap(keyScratch_);
+        permutation_.swap(permutationScratch_);
+    }
+}
+
+void engine::TileSorter::parallelRadixSort() {
+    constexpr std::size_t passCount = sizeof(std::uint64_t);
+    constexpr std::size_t bucketCount = 256;
+
+    const std::size_t count = keys_.size();
+    const std::size_t tasks = workerPool_->getTaskCount(count, ParallelGrain);
+
+    permutation_.resize(count);
+    permutationScratch_.resize(count);
+    keyScratch_.resize(count);
+    histograms_.resize(tasks * passCount);
+
+    // Every slice counts all of its digits up front. These counts stay valid for the
+    // first pass that actually moves anything, later passes recount their own digit
+    workerPool_->run(tasks, [&](std::size_t task) {
+        const WorkRange range = WorkerPool::split(count, tasks, task);
+
+        for (std::size_t pass = 0; pass < passCount; pass++) {
+            histograms_[task * passCount + pass].fill(0);
+        }
+
+        for (std::size_t i = range.begin; i < range.end; i++) {
+            const std::uint64_t key = keys_[i];
+
+            for (std::size_t pass = 0; pass < passCount; pass++) {
+                histograms_[task * passCount + pass][(key >> (pass * 8)) & 0xFF]++;
+            }
+
+            permutation_[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+
+    bool moved = false;
+
+    for (std::size_t pass = 0; pass < passCount; pass++) {
+        const std::size_t shift = pass * 8;
+        const std::size_t firstBucket = (keys_[0] >> shift) & 0xFF;
+
+        std::size_t firstBucketCount = 0;
+
+        for (std::size_t task = 0; task < tasks; task++) {
+            firstBucketCount += histograms_[task * passCount + pass][firstBucket];
+        }
+
+        if (firstBucketCount == count) {
+            continue;
+        }
+
+        if (moved) {
+            workerPool_->run(tasks, [&](std::size_t task) {
+                const WorkRange range = WorkerPool::split(count, tasks, task);
+                auto& histogram = histograms_[task * passCount + pass];
+
+                histogram.fill(0);
+
+                for (std::size_t i = range.begin; i < range.end; i++) {
+                    histogram[(keys_[i] >> shift) & 0xFF]++;
+                }
+            });
+        }
+
+        std::uint32_t offset = 0;
+
+        for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+            for (std::size_t task = 0; task < tasks; task++) {
+                auto& slot = histograms_[task * passCount + pass][bucket];
+                const std::uint32_t size = slot;
+
+                slot = offset;
+                offset += size;
+            }
+        }
+
+        workerPool_->run(tasks, [&](std::size_t task) {
+            const WorkRange range = WorkerPool::split(count, tasks, task);
+            auto& histogram = histograms_[task * passCount + pass];
+
+            for (std::size_t i = range.begin; i < range.end; i++) {
+                const std::uint32_t destination = histogram[(keys_[i] >> shift) & 0xFF]++;
+
+                keyScratch_[destination] = keys_[i];
+                permutationScratch_[destination] = permutation_[i];
+            }
+        });
+
+        keys_.swap(keyScratch_);
+        permutation_.swap(permutationScratch_);
+
+        moved = true;
+    }
+}
+
+bool engine::TileSorter::incrementalSort() {
+    const std::size_t count = keys_.size();
+    const std::size_t limit = count / IncrementalDivisor;
+
+    kept_.clear();
+    displaced_.clear();
+
+    // Split the previous frame's ordering into a sorted run and the few tiles that
+    // broke it. A descent either means the last kept tile moved up or this one moved
+    // down, and the following key tells us which of the two to displace
+    for (std::uint32_t i = 0; i < count; i++) {
+        const std::uint64_t key = keys_[i];
+
+        while (!kept_.empty() && keys_[kept_.back()] > key && (i + 1 == count || keys_[i + 1] < keys_[kept_.back()])) {
+            displaced_.push_back(kept_.back());
+            kept_.pop_back();
+        }
+
+        if (kept_.empty() || keys_[kept_.back()] <= key) {
+            kept_.push_back(i);
+        }
+        else {
+            displaced_.push_back(i);
+        }
+
+        if (displaced_.size() > limit) {
+            return false;
+        }
+    }
+
+    if (displaced_.empty()) {
+        permutation_.clear();
+        return true;
+    }
+
+    std::ranges::sort(displaced_, [&](std::uint32_t a, std::uint32_t b) {
+        return keys_[a] < keys_[b];
+    });
+
+    permutation_.resize(count);
+
+    std::ranges::merge(kept_, displaced_, permutation_.begin(), [&](std::uint32_t a, std::uint32_t b) {
+        return keys_[a] < keys_[b];
+    });
+
+    return true;
+}
+
+bool engine::TileSorter::mergeRuns() {
+    const std::size_t count = keys_.size();
+
+    // Whole groups arrive as pre-sorted runs, so a handful of runs can be merged
+    // pairwise for less than the radix passes would cost
+    runs_.clear();
+    runs_.push_back(0);
+
+    for (std::size_t i = 1; i < count; i++) {
+        if (keys_[i] < keys_[i - 1]) {
+            runs_.push_back(i);
+
+            if (runs_.size() > MaxMergedRuns) {
+                return false;
+            }
+        }
+    }
+
+    runs_.push_back(count);
+
+    permutation_.resize(count);
+    permutationScratch_.resize(count);
+
+    std::iota(permutation_.begin(), permutation_.end(), 0);
+
+    auto compare = [&](std::uint32_t a, std::uint32_t b) {
+        return keys_[a] < keys_[b];
+    };
+
+    while (runs_.size() > 2) {
+        const std::size_t runCount = runs_.size() - 1;
+        std::size_t merged = 0;
+
+        for (std::size_t run = 0; run < runCount; run += 2) {
+            const std::size_t begin = runs_[run];
+            const std::size_t middle = runs_[run + 1];
+            const std::size_t end = runs_[std::min(run + 2, runCount)];
+
+            std::merge(permutation_.begin() + begin, permutation_.begin() + middle, permutation_.begin() + middle, permutation_.begin() + end, permutationScratch_.begin() + begin, compare);
+
+            runs_[merged++] = begin;
+        }
+
+        runs_[merged++] = count;
+        runs_.resize(merged);
+
+        permutation_.swap(permutationScratch_);
+    }
+
+    return true;
+}
+
+engine::TileOrdering engine::TileSorter::finalise() {
+    const std::size_t count = permutation_.size();
+
+    std::size_t begin = 0;
+    std::size_t end = count;
+
+    while (begin < end && permutation_[begin] == begin) {
+        begin++;
+    }
+
+    while (end > begin && permutation_[end - 1] == end - 1) {
+        end--;
+    }
+
+    return {
+        .permutation = permutation_,
+        .begin = begin,
+        .end = end,
+    };
+}
\ No newline at end of file
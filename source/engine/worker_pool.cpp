@@ -0,0 +1,161 @@
+#include <engine/worker_pool.hpp>
+
+#include <algorithm>
+
+engine::WorkerPool::~WorkerPool() {
+    destroy();
+}
+
+void engine::WorkerPool::create(std::size_t threadCount) {
+    destroy();
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    stopping_ = false;
+
+    workers_.reserve(threadCount - 1);
+
+    for (std::size_t i = 1; i < threadCount; i++) {
+        workers_.emplace_back([this]() {
+            work();
+        });
+    }
+}
+
+void engine::WorkerPool::destroy() {
+    {
+        std::scoped_lock lock(mutex_);
+
+        stopping_ = true;
+    }
+
+    wakeCondition_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+
+    workers_.clear();
+}
+
+void engine::WorkerPool::run(std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+    std::unique_lock submitLock(submitMutex_, std::try_to_lock);
+
+    if (taskCount <= 1 || workers_.empty() || !submitLock.owns_lock()) {
+        for (std::size_t i = 0; i < taskCount; i++) {
+            task(i);
+        }
+
+        return;
+    }
+
+    {
+        std::scoped_lock lock(mutex_);
+
+        task_ = &task;
+        taskCount_ = taskCount;
+        nextTask_ = 0;
+        finishedTasks_ = 0;
+        generation_++;
+    }
+
+    wakeCondition_.notify_all();
+
+    drain();
+
+    std::unique_lock lock(mutex_);
+
+    // Workers still holding the job must leave before the task reference dies
+    doneCondition_.wait(lock, [&]() {
+        return finishedTasks_ == taskCount_ && activeWorkers_ == 0;
+    });
+
+    task_ = nullptr;
+}
+
+std::size_t engine::WorkerPool::getTaskCount(std::size_t count, std::size_t grain) const {
+    return std::clamp<std::size_t>((count + grain - 1) / std::max<std::size_t>(grain, 1), 1, getThreadCount());
+}
+
+engine::WorkRange engine::WorkerPool::split(std::size_t count, std::size_t parts, std::size_t part) {
+    return {
+        .begin = count * part / parts,
+        .end = count * (part + 1) / parts,
+    };
+}
+
+void engine::WorkerPool::work() {
+    std::uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+
+            wakeCondition_.wait(lock, [&]() {
+                return stopping_ || generation_ != seen;
+            });
+
+            if (stopping_) {
+                return;
+            }
+
+            seen = generation_;
+            activeWorkers_++;
+        }
+
+        drain();
+
+        {
+            std::scoped_lock lock(mutex_);
+
+            activeWorkers_--;
+        }
+
+        doneCondition_.notify_all();
+    }
+}
+
+void engine::WorkerPool::drain() {
+    while (true) {
+        std::size_t index;
+        const std::function<void(std::size_t)>* task;
+
+        {
+            std::scoped_lock lock(mutex_);
+
+            if (task_ == nullptr || nextTask_ >= taskCount_) {
+                return;
+            }
+
+            index = nextTask_++;
+            task = task_;
+        }
+
+        (*task)(index);
+
+        {
+            std::scoped_lock lock(mutex_);
+
+            finishedTasks_++;
+        }
+
+        doneCondition_.notify_all();
+    }
+}
+
+void engine::parallelFor(WorkerPool* pool, std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body) {
+    if (pool == nullptr || count < grain * 2) {
+        body(0, count);
+        return;
+    }
+
+    const std::size_t tasks = pool->getTaskCount(count, grain);
+
+    pool->run(tasks, [&](std::size_t task) {
+        const WorkRange range = WorkerPool::split(count, tasks, task);
+
+        body(range.begin, range.end);
+    });
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <engine/engine.hpp>
+#include <engine/world_commands.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+void engine::WorldCommandList::createChunk(ChunkBuild&& build) {
+    commands_.push_back({
+        .type = WorldCommandType::CREATE_CHUNK,
+        .build = std::move(build),
+    });
+}
+
+void engine::WorldCommandList::destroyChunk(glm::ivec3 position) {
+    commands_.push_back({
+        .type = WorldCommandType::DESTROY_CHUNK,
+        .build = {
+            .position = position,
+        },
+    });
+}
+
+void engine::WorldCommandQueue::submit(WorldCommandList& list) {
+    if (list.empty()) {
+        return;
+    }
+
+    std::scoped_lock lock(mutex_);
+
+    if (pending_.empty()) {
+        pending_.swap(list.commands_);
+    }
+    else {
+        std::ranges::move(list.commands_, std::back_inserter(pending_));
+    }
+
+    list.clear();
+}
+
+void engine::WorldCommandQueue::apply(Engine& engine) {
+    {
+        std::scoped_lock lock(mutex_);
+
+        applying_.swap(pending_);
+    }
+
+    for (auto& command : applying_) {
+        switch (command.type) {
+            case WorldCommandType::CREATE_CHUNK:
+                instantiateChunk(chunks_[command.build.position], std::move(command.build), engine);
+                break;
+
+            case WorldCommandType::DESTROY_CHUNK:
+                if (auto chunk = chunks_.take(command.build.position)) {
+                    unloadChunk(*chunk, engine);
+                }
+                break;
+        }
+    }
+
+    applying_.clear();
+}
+
+bool engine::WorldCommandQueue::isOccupied(glm::ivec3 position, glm::ivec3 chunkSize) const {
+    const glm::ivec3 origin = chunkSize * glm::ivec3(glm::floor(glm::vec3(position) / glm::vec3(chunkSize)));
+    const Chunk* chunk = chunks_.find(origin);
+
+    if (chunk == nullptr) {
+        return false;
+    }
+
+    const glm::ivec3 local = position - origin;
+
+    return chunk->spans.isOccupied(local.x, local.y, local.z);
+}
+
+std::optional<std::int32_t> engine::WorldCommandQueue::findTopTile(glm::ivec3 position, glm::ivec3 chunkSize) const {
+    glm::ivec3 origin = chunkSize * glm::ivec3(glm::floor(glm::vec3(position) / glm::vec3(chunkSize)));
+
+    const glm::ivec3 local = position - origin;
+
+    for (const Chunk* chunk = chunks_.find(origin); chunk != nullptr; chunk = chunks_.find(origin)) {
+        const std::int32_t top = chunk->spans.findTopTile(local.x, local.z);
+
+        if (top >= 0) {
+            return origin.y + top;
+        }
+
+        origin.y -= chunkSize.y;
+    }
+
+    return std::nullopt;
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include <components/transforms.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 engine::WorldGenerator::WorldGenerator(Engine& engine)
     : engine_(engine) {
     availableTiles_ = {
@@ -57,53 +60,525 @@ void engine::WorldGenerator::setChunkSize(glm::ivec3 size) {
     chunkSize_ = size;
 }
 
-void engine::WorldGenerator::generate() {
-    auto camera = engine_.getCurrentCamera();
+void engine::WorldGenerator::setRegionDirectory(const std::filesystem::path& directory) {
+    if (directory.empty()) {
+        regionCache_.close();
+        return;
+    }
 
-    auto& registry = engine_.getRegistry();
-    auto& cameraScale = registry.get<components::Scale>(camera);
-    auto& cameraPosition = registry.get<components::Position>(camera);
+    regionCache_.open(directory, chunkSize_);
+}
 
-    glm::vec2 cameraScreenPos = engine::worldToScreenSpace(cameraPosition.position);
-    glm::vec2 cameraChunkPos = glm::floor(cameraScreenPos * glm::vec2(1 / chunkSize_.x, 1 / chunkSize_.z));
-    glm::vec2 halfScale = cameraScale.scale * 0.5f;
-    glm::vec2 minVisibleArea = cameraScreenPos - halfScale;
-    glm::vec2 maxVisibleArea = cameraScreenPos + halfScale;
+void engine::WorldGenerator::setResidencyBudget(std::size_t bytes) {
+    residencyCache_.setBudget(bytes);
+}
 
-    loadedChunks_.reserve(static_cast<std::size_t>(worldSize_.x * worldSize_.y * worldSize_.z));
+void engine::WorldGenerator::setUnloadMargin(std::uint32_t chunks) {
+    unloadMargin_ = chunks;
+}
+
+void engine::WorldGenerator::setStreamBudget(std::chrono::microseconds budget) {
+    streamBudget_ = budget;
+}
+
+void engine::WorldGenerator::setPrefetchTime(std::chrono::milliseconds time) {
+    prefetchTime_ = time;
+}
+
+engine::ChunkResidencyStats engine::WorldGenerator::getResidencyStats() {
+    std::scoped_lock lock(statsMutex_);
+
+    return residencyStats_;
+}
+
+void engine::WorldGenerator::writePalette(TilePalette& palette) const {
+    for (std::uint32_t i = 0; i < availableTiles_.size(); i++) {
+        const Tile& tile = availableTiles_[i];
+
+        TileAppearance appearance = {
+            .texture = {
+                .sample = {
+                    .position = tile.textureOffset,
+                    .extent = tile.textureScale,
+                },
+                .offset = {0.0, 0.0},
+                .repeat = {1.0, 1.0},
+            },
+            .colourFactor = {1.0, 1.0, 1.0, 1.0},
+        };
+
+        palette.set(i, appearance);
+    }
+}
+
+void engine::WorldGenerator::setView(glm::vec3 cameraPosition, glm::vec2 cameraScale, glm::vec3 cameraVelocity) {
+    std::scoped_lock lock(viewMutex_);
+
+    cameraPosition_ = cameraPosition;
+    cameraScale_ = cameraScale;
+    cameraVelocity_ = cameraVelocity;
+}
+
+engine::ChunkHeightmap* engine::WorldGenerator::acquireHeightmap(glm::ivec2 column) {
+    auto& heightmap = loadedHeightmaps_[column];
+
+    heightmap.references++;
+
+    return &heightmap;
+}
+
+void engine::WorldGenerator::requestHeightmap(glm::ivec2 column, ChunkHeightmap* heightmap) {
+    // Chunks stacked on top of each other share their column's heights, so the noise
+    // is only sampled for the first one that has to be generated
+    if (!heightmap->sampled) {
+        heightmap->sampled = true;
+
+        pendingHeightmaps_.emplace_back(column, heightmap);
+    }
+}
+
+void engine::WorldGenerator::releaseHeightmap(glm::ivec2 column) {
+    auto iterator = loadedHeightmaps_.find(column);
+
+    if (iterator == loadedHeightmaps_.end()) {
+        return;
+    }
+
+    if (--iterator->second.references == 0) {
+        loadedHeightmaps_.erase(iterator);
+    }
+}
+
+void engine::WorldGenerator::buildChunk(PendingChunk& pending) {
+    // Chunks generated before come back from the residency cache or their region record,
+    // only chunks without one (or with a stale record) need the heightmap. Those are a
+    // heightfield and take their spans straight from it, the others are run-length coded
+    if (pending.resident) {
+        unpackOccupation(*pending.resident, pending.occupation);
+
+        pending.build.spans = ChunkColumnSpans(chunkSize_, pending.occupation.position);
+        determineChunkSpans(pending.build.spans, pending.occupation);
+    }
+    else if (!pending.record.empty() && decodeOccupation(pending.record, pending.occupation)) {
+        pending.build.spans = ChunkColumnSpans(chunkSize_, pending.occupation.position);
+        determineChunkSpans(pending.build.spans, pending.occupation);
+    }
+    else if (pending.heightmap->sampled) {
+        determineChunkTiles(pending.occupation, *pending.heightmap);
+
+        if (regionCache_.isOpen()) {
+            encodeOccupation(pending.occupation, pending.encoded);
+        }
+
+        pending.build.spans = ChunkColumnSpans(chunkSize_, pending.occupation.position);
+        determineChunkSpans(pending.build.spans, *pending.heightmap);
+    }
+    else {
+        return;
+    }
+
+    // The spans go to the main thread with the tiles for terrain queries, so the tiles
+    // come from them too instead of a scan over every cell
+    generateChunk(pending.build, pending.build.spans, availableTiles_);
+
+    pending.built = true;
+}
+
+engine::WorldView engine::WorldGenerator::captureView() {
+    glm::vec3 cameraPosition;
+    glm::vec3 cameraVelocity;
+    glm::vec2 cameraScale;
+
+    {
+        std::scoped_lock lock(viewMutex_);
+
+        cameraPosition = cameraPosition_;
+        cameraVelocity = cameraVelocity_;
+        cameraScale = cameraScale_;
+    }
+
+    const glm::ivec3 cameraChunk = glm::floor(cameraPosition / glm::vec3(chunkSize_));
+
+    // The prediction is snapped to chunks like the camera, so a steady pan only changes
+    // the view when either of them crosses a chunk border
+    const glm::vec3 predictedPosition = cameraPosition + cameraVelocity * std::chrono::duration<float>(prefetchTime_).count();
+    const glm::ivec3 predictedChunk = glm::floor(predictedPosition / glm::vec3(chunkSize_));
+
+    return {
+        .cameraChunk = {cameraChunk.x, 0, cameraChunk.z},
+        .prefetchOffset = {predictedChunk.x - cameraChunk.x, 0, predictedChunk.z - cameraChunk.z},
+        .scale = cameraScale,
+        .worldSize = worldSize_,
+        .unloadMargin = unloadMargin_,
+        .valid = true,
+    };
+}
+
+engine::ChunkRowSpans engine::WorldGenerator::computeRowSpans(const WorldView& view, std::int32_t y, std::int32_t z) const {
+    const glm::ivec3 windowBegin = view.getWindowBegin();
+    const glm::ivec3 windowEnd = view.getWindowEnd();
+
+    if (!view.valid || y < windowBegin.y || y >= windowEnd.y || z < windowBegin.z || z >= windowEnd.z) {
+        return {};
+    }
+
+    const glm::vec3 chunkExtent = glm::vec3(chunkSize_);
+    const glm::vec2 chunkSlack = {chunkExtent.x, chunkExtent.z};
+
+    // Pad the view by one chunk's footprint so it covers everything visible from
+    // anywhere inside the camera's chunk, not just from its corner
+    const glm::vec2 cameraScreenPos = engine::worldToScreenSpace(glm::vec3(view.cameraChunk) * chunkExtent);
+    const glm::vec2 padding = glm::abs(engine::worldToScreenSpace({chunkExtent.x, 0.0f, 0.0f})) + glm::abs(engine::worldToScreenSpace({0.0f, 0.0f, chunkExtent.z}));
+    const glm::vec2 halfScale = view.scale * 0.5f + padding + chunkSlack;
 
-    for (int y = -worldSize_.y; y < worldSize_.y; ++y) {
-        for (int x = -worldSize_.x; x < worldSize_.x; ++x) {
-            for (int z = -worldSize_.z; z < worldSize_.z; ++z) {
-                glm::ivec3 chunkPosWorld = glm::ivec3(cameraChunkPos.x, 0.0, cameraChunkPos.y) + (glm::ivec3(chunkSize_) * glm::ivec3{x, y, z});
-                glm::vec2 chunkScreenPos = engine::worldToScreenSpace(glm::vec3(chunkPosWorld));
+    // Chunks load as soon as they touch the view but only unload once they are a margin
+    // further out, so moving back and forth over a chunk border does not thrash them
+    const glm::vec2 unloadMargin = static_cast<float>(view.unloadMargin) * chunkSlack;
 
-                bool chunkExists = loadedChunks_.contains(chunkPosWorld);
-                bool isInvalidPosition = chunkScreenPos.x + static_cast<float>(chunkSize_.x) < minVisibleArea.x ||
-                                         chunkScreenPos.x - static_cast<float>(chunkSize_.x) > maxVisibleArea.x ||
-                                         chunkScreenPos.y + static_cast<float>(chunkSize_.z) < minVisibleArea.y ||
-                                         chunkScreenPos.y - static_cast<float>(chunkSize_.z) > maxVisibleArea.y;
+    // Chunks along the predicted path load ahead of time. The view is swept there in
+    // steps no longer than its own half size so the swept spans cover the whole path
+    const glm::vec2 prefetchScreen = engine::worldToScreenSpace(glm::vec3(view.prefetchOffset) * chunkExtent);
+    const float stepLength = std::min(halfScale.x, halfScale.y);
+    const std::int32_t sweepSteps = std::min(static_cast<std::int32_t>(std::ceil(glm::length(prefetchScreen) / stepLength)), MaxPrefetchSteps);
 
-                if (isInvalidPosition && chunkExists) {
-                    auto& chunk = loadedChunks_[chunkPosWorld];
+    const glm::vec2 rowBase = engine::worldToScreenSpace({0.0f, static_cast<float>(y) * chunkExtent.y, static_cast<float>(z) * chunkExtent.z});
+    const glm::vec2 rowStep = engine::worldToScreenSpace({chunkExtent.x, 0.0f, 0.0f});
 
-                    unloadChunk(chunk, engine_);
+    const float boxBegin = static_cast<float>(windowBegin.x);
+    const float boxLast = static_cast<float>(windowEnd.x - 1);
 
-                    loadedChunks_.erase(chunkPosWorld);
-                    loadedChunkOccupations_.erase(chunkPosWorld);
+    // A row's screen position is linear in x, so the chunks inside a rectangle form
+    // one contiguous span that can be solved for directly
+    auto solve = [&](glm::vec2 minimum, glm::vec2 maximum) -> ChunkSpan {
+        float first = boxBegin;
+        float last = boxLast;
+
+        for (int axis = 0; axis < 2; axis++) {
+            if (rowStep[axis] == 0.0f) {
+                if (rowBase[axis] < minimum[axis] || rowBase[axis] > maximum[axis]) {
+                    return {};
                 }
-                else if (!isInvalidPosition && !chunkExists) {
-                    auto& chunk = loadedChunks_[chunkPosWorld];
-                    auto& chunkTilemap = loadedChunkOccupations_[chunkPosWorld];
 
-                    chunkTilemap = ChunkOccupationMap(chunkSize_, chunkPosWorld);
+                continue;
+            }
+
+            const float a = (minimum[axis] - rowBase[axis]) / rowStep[axis];
+            const float b = (maximum[axis] - rowBase[axis]) / rowStep[axis];
+
+            first = std::max(first, std::min(a, b));
+            last = std::min(last, std::max(a, b));
+        }
+
+        if (first > last) {
+            return {};
+        }
+
+        const ChunkSpan span = {
+            .begin = static_cast<std::int32_t>(std::ceil(first)),
+            .end = static_cast<std::int32_t>(std::floor(last)) + 1,
+        };
+
+        return span.begin < span.end ? span : ChunkSpan{};
+    };
+
+    auto extend = [](ChunkSpan& span, ChunkSpan other) {
+        if (other.begin >= other.end) {
+            return;
+        }
+
+        if (span.begin >= span.end) {
+            span = other;
+            return;
+        }
+
+        span.begin = std::min(span.begin, other.begin);
+        span.end = std::max(span.end, other.end);
+    };
+
+    ChunkRowSpans spans;
+
+    for (std::int32_t step = 0; step <= sweepSteps; step++) {
+        const float progress = sweepSteps == 0 ? 0.0f : static_cast<float>(step) / static_cast<float>(sweepSteps);
+        const glm::vec2 centre = cameraScreenPos + prefetchScreen * progress;
+
+        extend(spans.load, solve(centre - halfScale, centre + halfScale));
+        extend(spans.keep, solve(centre - halfScale - unloadMargin, centre + halfScale + unloadMargin));
+    }
+
+    extend(spans.keep, spans.load);
+
+    return spans;
+}
+
+void engine::WorldGenerator::loadChunk(glm::ivec3 position) {
+    const glm::ivec2 column = {position.x, position.z};
+
+    ChunkHeightmap* heightmap = acquireHeightmap(column);
+
+    windowLoads_++;
+
+    // Revisits skip the region files and the noise. A kept build goes straight back to
+    // the main thread, one the cache gave up is rebuilt from the resident occupation
+    // along with the rest of the batch
+    if (auto resident = residencyCache_.take(position)) {
+        windowRevisits_++;
+
+        if (resident->build) {
+            commands_.createChunk(ChunkBuild(*resident->build));
+            loadedChunks_.insert(position, std::move(*resident));
+
+            return;
+        }
+
+        pendingChunks_.push_back(PendingChunk{
+            .occupation = {},
+            .build = {},
+            .heightmap = heightmap,
+            .record = {},
+            .encoded = {},
+            .resident = std::move(resident->occupation),
+        });
+
+        return;
+    }
+
+    auto& pending = pendingChunks_.emplace_back(PendingChunk{
+        .occupation = ChunkOccupationMap(chunkSize_, position),
+        .build = {},
+        .heightmap = heightmap,
+        .record = regionCache_.find(position),
+        .encoded = {},
+        .resident = {},
+    });
+
+    if (pending.record.empty()) {
+        requestHeightmap(column, pending.heightmap);
+    }
+}
+
+void engine::WorldGenerator::evictChunk(glm::ivec3 position) {
+    auto resident = loadedChunks_.take(position);
+
+    if (!resident) {
+        return;
+    }
+
+    commands_.destroyChunk(position);
+
+    residencyCache_.insert(position, std::move(*resident));
+
+    releaseHeightmap({position.x, position.z});
+
+    windowUnloads_++;
+}
+
+void engine::WorldGenerator::updateFrontier(const WorldView& view) {
+    loadedChunks_.reserve(static_cast<std::size_t>(worldSize_.x * worldSize_.y * worldSize_.z));
+
+    // Everything loaded or requested lies inside the previous view's keep spans and
+    // everything in its load spans is one of the two, so only the chunks that left a
+    // keep span or entered a load span have to be looked at
+    auto forEachOutside = [](ChunkSpan span, ChunkSpan excluded, auto&& function) {
+        if (excluded.begin >= excluded.end) {
+            excluded = {span.end, span.end};
+        }
+
+        for (std::int32_t x = span.begin; x < std::min(span.end, excluded.begin); x++) {
+            function(x);
+        }
+
+        for (std::int32_t x = std::max(span.begin, excluded.end); x < span.end; x++) {
+            function(x);
+        }
+    };
+
+    glm::ivec3 rowsBegin = view.getWindowBegin();
+    glm::ivec3 rowsEnd = view.getWindowEnd();
 
-                    chunk.position = chunkPosWorld;
+    if (currentView_.valid) {
+        rowsBegin = glm::min(rowsBegin, currentView_.getWindowBegin());
+        rowsEnd = glm::max(rowsEnd, currentView_.getWindowEnd());
+    }
 
-                    determineChunkTiles(chunkTilemap, engine_);
-                    generateChunk(chunk, chunkTilemap, engine_);
+    const glm::ivec3 chunkSize = glm::ivec3(chunkSize_);
+
+    for (std::int32_t y = rowsBegin.y; y < rowsEnd.y; y++) {
+        for (std::int32_t z = rowsBegin.z; z < rowsEnd.z; z++) {
+            const ChunkRowSpans previous = computeRowSpans(currentView_, y, z);
+            const ChunkRowSpans next = computeRowSpans(view, y, z);
+
+            // Requests that leave before they were built are simply dropped
+            forEachOutside(previous.keep, next.keep, [&](std::int32_t x) {
+                const glm::ivec3 position = chunkSize * glm::ivec3{x, y, z};
+
+                if (!requestedChunks_.erase(position)) {
+                    evictChunk(position);
+                }
+            });
+
+            forEachOutside(next.load, previous.load, [&](std::int32_t x) {
+                const glm::ivec3 position = chunkSize * glm::ivec3{x, y, z};
+
+                if (!loadedChunks_.contains(position) && !requestedChunks_.contains(position)) {
+                    requestedChunks_.insert(position, true);
+                    streamQueue_.push_back({.position = position});
                 }
+            });
+        }
+    }
+
+    currentView_ = view;
+
+    prioritiseRequests();
+}
+
+void engine::WorldGenerator::prioritiseRequests() {
+    const glm::ivec3 chunkSize = glm::ivec3(chunkSize_);
+
+    std::erase_if(streamQueue_, [&](const StreamRequest& request) {
+        return !requestedChunks_.contains(request.position);
+    });
+
+    for (auto& request : streamQueue_) {
+        const glm::ivec3 offset = request.position / chunkSize - currentView_.cameraChunk;
+
+        request.distance = static_cast<std::int64_t>(offset.x) * offset.x + static_cast<std::int64_t>(offset.y) * offset.y + static_cast<std::int64_t>(offset.z) * offset.z;
+    }
+
+    std::ranges::make_heap(streamQueue_, StreamRequest::Farther{});
+}
+
+void engine::WorldGenerator::streamChunks() {
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t batchSize = engine_.getWorkerPool().getThreadCount() * StreamBatchPerThread;
+
+    // Nearest chunks go first, a batch at a time so the pool stays busy, until the
+    // budget runs out. At least one batch is loaded per tick so streaming never stalls
+    while (!streamQueue_.empty()) {
+        for (std::size_t i = 0; i < batchSize && !streamQueue_.empty(); i++) {
+            std::ranges::pop_heap(streamQueue_, StreamRequest::Farther{});
+
+            const glm::ivec3 position = streamQueue_.back().position;
+
+            streamQueue_.pop_back();
+
+            // Cancelled and re-requested chunks can be queued twice, only the first counts
+            if (requestedChunks_.erase(position)) {
+                loadChunk(position);
+            }
+        }
+
+        buildPendingChunks();
+
+        if (streamBudget_.count() > 0 && std::chrono::steady_clock::now() - start >= streamBudget_) {
+            break;
+        }
+    }
+}
+
+void engine::WorldGenerator::buildPendingChunks() {
+    // New chunks only read shared state, so every heightmap and then every chunk is
+    // built as its own task and the results are merged back in order
+    auto& workerPool = engine_.getWorkerPool();
+
+    auto computeHeightmaps = [&]() {
+        workerPool.run(pendingHeightmaps_.size(), [&](std::size_t index) {
+            auto& [column, heightmap] = pendingHeightmaps_[index];
+
+            computeChunkHeightmap(*heightmap, column, engine_);
+        });
+
+        pendingHeightmaps_.clear();
+    };
+
+    computeHeightmaps();
+
+    workerPool.run(pendingChunks_.size(), [&](std::size_t index) {
+        buildChunk(pendingChunks_[index]);
+    });
+
+    // Records that failed to decode fall back to generating the chunk
+    for (auto& pending : pendingChunks_) {
+        if (!pending.built) {
+            requestHeightmap({pending.occupation.position.x, pending.occupation.position.z}, pending.heightmap);
+        }
+    }
+
+    if (!pendingHeightmaps_.empty()) {
+        computeHeightmaps();
+
+        for (auto& pending : pendingChunks_) {
+            if (!pending.built) {
+                buildChunk(pending);
             }
         }
     }
+
+    for (auto& pending : pendingChunks_) {
+        const glm::ivec3 position = pending.occupation.position;
+
+        if (!pending.encoded.empty()) {
+            regionCache_.store(position, pending.encoded);
+        }
+
+        ResidentChunk resident = {
+            .occupation = {},
+            .build = pending.build,
+        };
+
+        commands_.createChunk(std::move(pending.build));
+
+        if (pending.resident) {
+            resident.occupation = std::move(*pending.resident);
+        }
+        else {
+            packOccupation(pending.occupation, resident.occupation);
+        }
+
+        loadedChunks_.insert(position, std::move(resident));
+    }
+
+    pendingChunks_.clear();
+
+    regionCache_.trim();
+}
+
+void engine::WorldGenerator::generate() {
+    const WorldView view = captureView();
+
+    if (view != currentView_) {
+        updateFrontier(view);
+    }
+
+    streamChunks();
+
+    updateResidencyStats();
+
+    engine_.getWorldCommandQueue().submit(commands_);
+}
+
+void engine::WorldGenerator::updateResidencyStats() {
+    const auto now = std::chrono::steady_clock::now();
+    const float elapsed = std::chrono::duration<float>(now - statsWindowStart_).count();
+
+    if (elapsed < 1.0f) {
+        return;
+    }
+
+    {
+        std::scoped_lock lock(statsMutex_);
+
+        residencyStats_ = {
+            .loadsPerSecond = static_cast<float>(windowLoads_) / elapsed,
+            .unloadsPerSecond = static_cast<float>(windowUnloads_) / elapsed,
+            .revisitsPerSecond = static_cast<float>(windowRevisits_) / elapsed,
+            .cachedChunks = residencyCache_.size(),
+            .cachedBytes = residencyCache_.getMemoryUsage(),
+        };
+    }
+
+    statsWindowStart_ = now;
+    windowLoads_ = 0;
+    windowUnloads_ = 0;
+    windowRevisits_ = 0;
 }
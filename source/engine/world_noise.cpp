@@ -0,0 +1,536 @@
+#include <engine/world_noise.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__AVX512F__)
+#define ENGINE_NOISE_AVX512
+#elif defined(__AVX2__)
+#define ENGINE_NOISE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_NOISE_SSE2
+#endif
+
+#if defined(ENGINE_NOISE_AVX512) || defined(ENGINE_NOISE_AVX2) || defined(ENGINE_NOISE_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Each lane type wraps one register and provides the handful of operations the
+    // kernels need, so the kernels themselves are written once for every width
+    struct Float1 {
+        using Mask = bool;
+
+        constexpr static std::size_t Width = 1;
+
+        Float1(float value)
+            : v(value) {
+        }
+
+        static Float1 load(const float* source) {
+            return *source;
+        }
+
+        void store(float* destination) const {
+            *destination = v;
+        }
+
+        float v;
+    };
+
+    inline Float1 operator+(Float1 a, Float1 b) {
+        return a.v + b.v;
+    }
+
+    inline Float1 operator-(Float1 a, Float1 b) {
+        return a.v - b.v;
+    }
+
+    inline Float1 operator*(Float1 a, Float1 b) {
+        return a.v * b.v;
+    }
+
+    inline Float1 operator/(Float1 a, Float1 b) {
+        return a.v / b.v;
+    }
+
+    inline Float1 floor(Float1 a) {
+        return std::floor(a.v);
+    }
+
+    inline Float1 abs(Float1 a) {
+        return std::abs(a.v);
+    }
+
+    inline Float1 min(Float1 a, Float1 b) {
+        return b.v < a.v ? b.v : a.v;
+    }
+
+    inline Float1 max(Float1 a, Float1 b) {
+        return a.v < b.v ? b.v : a.v;
+    }
+
+    inline bool greaterThan(Float1 a, Float1 b) {
+        return a.v > b.v;
+    }
+
+    inline bool greaterEqual(Float1 a, Float1 b) {
+        return a.v >= b.v;
+    }
+
+    inline Float1 select(bool mask, Float1 a, Float1 b) {
+        return mask ? a : b;
+    }
+
+#if defined(ENGINE_NOISE_SSE2)
+    struct Float4 {
+        using Mask = __m128;
+
+        constexpr static std::size_t Width = 4;
+
+        Float4(__m128 value)
+            : v(value) {
+        }
+
+        Float4(float value)
+            : v(_mm_set1_ps(value)) {
+        }
+
+        static Float4 load(const float* source) {
+            return _mm_loadu_ps(source);
+        }
+
+        void store(float* destination) const {
+            _mm_storeu_ps(destination, v);
+        }
+
+        __m128 v;
+    };
+
+    inline Float4 operator+(Float4 a, Float4 b) {
+        return _mm_add_ps(a.v, b.v);
+    }
+
+    inline Float4 operator-(Float4 a, Float4 b) {
+        return _mm_sub_ps(a.v, b.v);
+    }
+
+    inline Float4 operator*(Float4 a, Float4 b) {
+        return _mm_mul_ps(a.v, b.v);
+    }
+
+    inline Float4 operator/(Float4 a, Float4 b) {
+        return _mm_div_ps(a.v, b.v);
+    }
+
+    inline Float4 floor(Float4 a) {
+#if defined(__SSE4_1__)
+        return _mm_floor_ps(a.v);
+#else
+        // Truncate, then step down where truncation rounded up. Noise coordinates stay
+        // far inside the int32 range
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f)));
+#endif
+    }
+
+    inline Float4 abs(Float4 a) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v);
+    }
+
+    inline Float4 min(Float4 a, Float4 b) {
+        return _mm_min_ps(a.v, b.v);
+    }
+
+    inline Float4 max(Float4 a, Float4 b) {
+        return _mm_max_ps(a.v, b.v);
+    }
+
+    inline __m128 greaterThan(Float4 a, Float4 b) {
+        return _mm_cmpgt_ps(a.v, b.v);
+    }
+
+    inline __m128 greaterEqual(Float4 a, Float4 b) {
+        return _mm_cmpge_ps(a.v, b.v);
+    }
+
+    inline Float4 select(__m128 mask, Float4 a, Float4 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v));
+    }
+
+    using Lanes = Float4;
+#endif
+
+#if defined(ENGINE_NOISE_AVX2)
+    struct Float8 {
+        using Mask = __m256;
+
+        constexpr static std::size_t Width = 8;
+
+        Float8(__m256 value)
+            : v(value) {
+        }
+
+        Float8(float value)
+            : v(_mm256_set1_ps(value)) {
+        }
+
+        static Float8 load(const float* source) {
+            return _mm256_loadu_ps(source);
+        }
+
+        void store(float* destination) const {
+            _mm256_storeu_ps(destination, v);
+        }
+
+        __m256 v;
+    };
+
+    inline Float8 operator+(Float8 a, Float8 b) {
+        return _mm256_add_ps(a.v, b.v);
+    }
+
+    inline Float8 operator-(Float8 a, Float8 b) {
+        return _mm256_sub_ps(a.v, b.v);
+    }
+
+    inline Float8 operator*(Float8 a, Float8 b) {
+        return _mm256_mul_ps(a.v, b.v);
+    }
+
+    inline Float8 operator/(Float8 a, Float8 b) {
+        return _mm256_div_ps(a.v, b.v);
+    }
+
+    inline Float8 floor(Float8 a) {
+        return _mm256_floor_ps(a.v);
+    }
+
+    inline Float8 abs(Float8 a) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v);
+    }
+
+    inline Float8 min(Float8 a, Float8 b) {
+        return _mm256_min_ps(a.v, b.v);
+    }
+
+    inline Float8 max(Float8 a, Float8 b) {
+        return _mm256_max_ps(a.v, b.v);
+    }
+
+    inline __m256 greaterThan(Float8 a, Float8 b) {
+        return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ);
+    }
+
+    inline __m256 greaterEqual(Float8 a, Float8 b) {
+        return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ);
+    }
+
+    inline Float8 select(__m256 mask, Float8 a, Float8 b) {
+        return _mm256_blendv_ps(b.v, a.v, mask);
+    }
+
+    using Lanes = Float8;
+#endif
+
+#if defined(ENGINE_NOISE_AVX512)
+    struct Float16 {
+        using Mask = __mmask16;
+
+        constexpr static std::size_t Width = 16;
+
+        Float16(__m512 value)
+            : v(value) {
+        }
+
+        Float16(float value)
+            : v(_mm512_set1_ps(value)) {
+        }
+
+        static Float16 load(const float* source) {
+            return _mm512_loadu_ps(source);
+        }
+
+        void store(float* destination) const {
+            _mm512_storeu_ps(destination, v);
+        }
+
+        __m512 v;
+    };
+
+    inline Float16 operator+(Float16 a, Float16 b) {
+        return _mm512_add_ps(a.v, b.v);
+    }
+
+    inline Float16 operator-(Float16 a, Float16 b) {
+        return _mm512_sub_ps(a.v, b.v);
+    }
+
+    inline Float16 operator*(Float16 a, Float16 b) {
+        return _mm512_mul_ps(a.v, b.v);
+    }
+
+    inline Float16 operator/(Float16 a, Float16 b) {
+        return _mm512_div_ps(a.v, b.v);
+    }
+
+    inline Float16 floor(Float16 a) {
+        return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+
+    inline Float16 abs(Float16 a) {
+        return _mm512_abs_ps(a.v);
+    }
+
+    inline Float16 min(Float16 a, Float16 b) {
+        return _mm512_min_ps(a.v, b.v);
+    }
+
+    inline Float16 max(Float16 a, Float16 b) {
+        return _mm512_max_ps(a.v, b.v);
+    }
+
+    inline __mmask16 greaterThan(Float16 a, Float16 b) {
+        return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ);
+    }
+
+    inline __mmask16 greaterEqual(Float16 a, Float16 b) {
+        return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ);
+    }
+
+    inline Float16 select(__mmask16 mask, Float16 a, Float16 b) {
+        return _mm512_mask_blend_ps(mask, b.v, a.v);
+    }
+
+    using Lanes = Float16;
+#endif
+
+#if !defined(ENGINE_NOISE_AVX512) && !defined(ENGINE_NOISE_AVX2) && !defined(ENGINE_NOISE_SSE2)
+    using Lanes = Float1;
+#endif
+
+    template <typename F>
+    F fract(F x) {
+        return x - floor(x);
+    }
+
+    template <typename F>
+    F mod289(F x) {
+        return x - floor(x * F(1.0f / 289.0f)) * F(289.0f);
+    }
+
+    template <typename F>
+    F permute(F x) {
+        return mod289((x * F(34.0f) + F(1.0f)) * x);
+    }
+
+    template <typename F>
+    F taylorInvSqrt(F r) {
+        return F(1.79284291400159f) - F(0.85373472095314f) * r;
+    }
+
+    // Same steps as glm::simplex(vec2), one corner at a time instead of in vec3s
+    template <typename F>
+    F simplex(F vx, F vy) {
+        const F cx = 0.211324865405187f;
+        const F cy = 0.366025403784439f;
+        const F cz = -0.577350269189626f;
+        const F cw = 0.024390243902439f;
+
+        const F skew = vx * cy + vy * cy;
+
+        F ix = floor(vx + skew);
+        F iy = floor(vy + skew);
+
+        const F unskew = ix * cx + iy * cx;
+
+        const F x0 = vx - ix + unskew;
+        const F y0 = vy - iy + unskew;
+
+        const F i1x = select(greaterThan(x0, y0), F(1.0f), F(0.0f));
+        const F i1y = F(1.0f) - i1x;
+
+        const F x1 = x0 + cx - i1x;
+        const F y1 = y0 + cx - i1y;
+        const F x2 = x0 + cz;
+        const F y2 = y0 + cz;
+
+        ix = ix - F(289.0f) * floor(ix / F(289.0f));
+        iy = iy - F(289.0f) * floor(iy / F(289.0f));
+
+        auto corner = [&](F p, F x, F y) {
+            F m = max(F(0.5f) - (x * x + y * y), F(0.0f));
+
+            m = m * m;
+            m = m * m;
+
+            const F gx = F(2.0f) * fract(p * cw) - F(1.0f);
+            const F h = abs(gx) - F(0.5f);
+            const F a0 = gx - floor(gx + F(0.5f));
+
+            m = m * taylorInvSqrt(a0 * a0 + h * h);
+
+            return m * (a0 * x + h * y);
+        };
+
+        const F n0 = corner(permute(permute(iy) + ix), x0, y0);
+        const F n1 = corner(permute(permute(iy + i1y) + ix + i1x), x1, y1);
+        const F n2 = corner(permute(permute(iy + F(1.0f)) + ix + F(1.0f)), x2, y2);
+
+        return F(130.0f) * (n0 + n1 + n2);
+    }
+
+    // Same steps as glm::simplex(vec3)
+    template <typename F>
+    F simplex(F vx, F vy, F vz) {
+        const F cx = 1.0f / 6.0f;
+        const F cy = 1.0f / 3.0f;
+
+        const F skew = vx * cy + vy * cy + vz * cy;
+
+        F ix = floor(vx + skew);
+        F iy = floor(vy + skew);
+        F iz = floor(vz + skew);
+
+        const F unskew = ix * cx + iy * cx + iz * cx;
+
+        const F x0 = vx - ix + unskew;
+        const F y0 = vy - iy + unskew;
+        const F z0 = vz - iz + unskew;
+
+        const F gx = select(greaterEqual(x0, y0), F(1.0f), F(0.0f));
+        const F gy = select(greaterEqual(y0, z0), F(1.0f), F(0.0f));
+        const F gz = select(greaterEqual(z0, x0), F(1.0f), F(0.0f));
+
+        const F lx = F(1.0f) - gx;
+        const F ly = F(1.0f) - gy;
+        const F lz = F(1.0f) - gz;
+
+        const F i1x = min(gx, lz);
+        const F i1y = min(gy, lx);
+        const F i1z = min(gz, ly);
+
+        const F i2x = max(gx, lz);
+        const F i2y = max(gy, lx);
+        const F i2z = max(gz, ly);
+
+        ix = mod289(ix);
+        iy = mod289(iy);
+        iz = mod289(iz);
+
+        const F nsx = 2.0f / 7.0f;
+        const F nsy = 0.5f / 7.0f - 1.0f;
+        const F nsz = 0.142857142857f;
+
+        auto corner = [&](F p, F x, F y, F z) {
+            const F j = p - F(49.0f) * floor(p * nsz * nsz);
+
+            const F gridX = floor(j * nsz);
+            const F gridY = floor(j - F(7.0f) * gridX);
+
+            const F ax = gridX * nsx + nsy;
+            const F ay = gridY * nsx + nsy;
+            const F h = F(1.0f) - abs(ax) - abs(ay);
+
+            const F sh = select(greaterThan(h, F(0.0f)), F(0.0f), F(-1.0f));
+
+            const F px = ax + (floor(ax) * F(2.0f) + F(1.0f)) * sh;
+            const F py = ay + (floor(ay) * F(2.0f) + F(1.0f)) * sh;
+            const F norm = taylorInvSqrt(px * px + py * py + h * h);
+
+            F m = max(F(0.6f) - (x * x + y * y + z * z), F(0.0f));
+
+            m = m * m;
+
+            return m * m * ((px * x + py * y + h * z) * norm);
+        };
+
+        const F n0 = corner(permute(permute(permute(iz) + iy) + ix), x0, y0, z0);
+        const F n1 = corner(permute(permute(permute(iz + i1z) + iy + i1y) + ix + i1x), x0 - i1x + cx, y0 - i1y + cx, z0 - i1z + cx);
+        const F n2 = corner(permute(permute(permute(iz + i2z) + iy + i2y) + ix + i2x), x0 - i2x + cy, y0 - i2y + cy, z0 - i2z + cy);
+        const F n3 = corner(permute(permute(permute(iz + F(1.0f)) + iy + F(1.0f)) + ix + F(1.0f)), x0 - F(0.5f), y0 - F(0.5f), z0 - F(0.5f));
+
+        return F(42.0f) * (n0 + n1 + n2 + n3);
+    }
+
+    template <std::size_t Dimensions>
+    void sampleBatch(std::array<std::span<const float>, Dimensions> coordinates, std::span<float> result) {
+        for (const auto& axis : coordinates) {
+            if (axis.size() != result.size()) {
+                throw std::runtime_error("Call failed: engine::WorldNoiseSystem::sample(): Coordinate and result sizes differ");
+            }
+        }
+
+        auto evaluate = [](const std::array<const float*, Dimensions>& source, float* destination) {
+            if constexpr (Dimensions == 2) {
+                simplex(Lanes::load(source[0]), Lanes::load(source[1])).store(destination);
+            }
+            else {
+                simplex(Lanes::load(source[0]), Lanes::load(source[1]), Lanes::load(source[2])).store(destination);
+            }
+        };
+
+        const std::size_t count = result.size();
+        const std::size_t full = count - count % Lanes::Width;
+
+        std::array<const float*, Dimensions> source;
+
+        for (std::size_t i = 0; i < full; i += Lanes::Width) {
+            for (std::size_t axis = 0; axis < Dimensions; axis++) {
+                source[axis] = coordinates[axis].data() + i;
+            }
+
+            evaluate(source, result.data() + i);
+        }
+
+        if (full == count) {
+            return;
+        }
+
+        // Run the remainder through the same kernel so every sample gets identical
+        // results no matter where it falls in the batch
+        std::array<std::array<float, Lanes::Width>, Dimensions> padded = {};
+        std::array<float, Lanes::Width> tail = {};
+
+        for (std::size_t axis = 0; axis < Dimensions; axis++) {
+            std::copy(coordinates[axis].begin() + full, coordinates[axis].end(), padded[axis].begin());
+
+            source[axis] = padded[axis].data();
+        }
+
+        evaluate(source, tail.data());
+
+        std::copy_n(tail.begin(), count - full, result.begin() + full);
+    }
+}
+
+float engine::WorldNoiseSystem::sample(const glm::vec2& position) const {
+    float result = 0.0f;
+
+    sampleBatch<2>({std::span(&position.x, 1), std::span(&position.y, 1)}, std::span(&result, 1));
+
+    return result;
+}
+
+float engine::WorldNoiseSystem::sample(const glm::vec3& position) const {
+    float result = 0.0f;
+
+    sampleBatch<3>({std::span(&position.x, 1), std::span(&position.y, 1), std::span(&position.z, 1)}, std::span(&result, 1));
+
+    return result;
+}
+
+void engine::WorldNoiseSystem::sample(std::span<const float> x, std::span<const float> y, std::span<float> result) const {
+    sampleBatch<2>({x, y}, result);
+}
+
+void engine::WorldNoiseSystem::sample(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<float> result) const {
+    sampleBatch<3>({x, y, z}, result);
+}
+
+std::size_t engine::WorldNoiseSystem::getBatchWidth() {
+    return Lanes::Width;
+}
\ No newline at end of file
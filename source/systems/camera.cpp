@@ -120,6 +120,22 @@ void systems::cameras::makeCamerasFollowTarget(engine::Engine& engine) {
     }
 }
 
+glm::vec3 systems::cameras::getCameraVelocity(engine::Engine& engine) {
+    using namespace components;
+
+    auto& registry = engine.getRegistry();
+    auto cameraEntity = engine.getCurrentCamera();
+
+    // Cameras only move on their own while following a target
+    auto* target = registry.try_get<CameraTarget>(cameraEntity);
+
+    if (target == nullptr || !registry.all_of<Velocity>(target->target)) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+
+    return registry.get<Velocity>(target->target).velocity;
+}
+
 void systems::cameras::uploadCameraData(engine::Engine& engine) {
     using namespace components;
 
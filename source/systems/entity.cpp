@@ -10,16 +10,16 @@ void systems::entities::createEntities(engine::Engine& engine) {
     using namespace components;
 
     auto& registry = engine.getRegistry();
-    auto& tilePool = engine.getEntityTilePool();
+    const auto& tilePool = engine.getEntityTilePool();
     auto view = registry.view<TileProxy, EntityTag>();
 
     for (auto [entity, proxy] : view.each()) {
         auto& position = registry.emplace_or_replace<Position>(entity);
         auto& scale = registry.emplace_or_replace<Scale>(entity);
-        auto& instance = tilePool.getInstance(proxy);
+        const auto& transform = tilePool.getTransform(proxy);
 
-        position.position = engine::screenToWorldSpace(instance.transform.position);
-        scale.scale = instance.transform.scale;
+        position.position = engine::unpackTilePosition(transform.position);
+        scale.scale = engine::unpackTileScale(transform.scale);
     }
 }
 
@@ -29,8 +29,16 @@ void systems::entities::sortEntities(engine::Engine& engine) {
     auto& registry = engine.getRegistry();
     auto& tilePool = engine.getEntityTilePool();
     auto& worldGenerator = engine.getWorldGenerator();
-    auto worldSize = worldGenerator.getWorldSize();
+    auto chunkSize = worldGenerator.getChunkSize();
     auto view = registry.view<TileProxy, Position, EntityTag>();
+
+    for (auto [entity, proxy, position] : view.each()) {
+        if (!tilePool.contains(proxy)) {
+            continue;
+        }
+
+        tilePool.setOrder(proxy, engine::computeTileOrder(position.position, chunkSize));
+    }
 }
 
 void systems::entities::updateControllers(engine::Engine& engine) {
@@ -66,3 +74,28 @@ void systems::entities::updateControllers(engine::Engine& engine) {
         }
     }
 }
+
+void systems::entities::placeOnTerrain(engine::Engine& engine) {
+    using namespace components;
+
+    auto& registry = engine.getRegistry();
+    auto& worldGenerator = engine.getWorldGenerator();
+    const auto& worldCommands = engine.getWorldCommandQueue();
+    auto chunkSize = worldGenerator.getChunkSize();
+    auto worldTop = chunkSize.y * worldGenerator.getWorldSize().y - 1;
+    auto view = registry.view<Position, EntityTag>();
+
+    // Entities stand on the terrain. The column is only searched once an entity ended up
+    // inside it or above an empty cell, columns without loaded chunks leave it be
+    for (auto [entity, position] : view.each()) {
+        const glm::ivec3 cell = glm::floor(position.position);
+
+        if (!worldCommands.isOccupied(cell, chunkSize) && worldCommands.isOccupied(cell - glm::ivec3{0, 1, 0}, chunkSize)) {
+            continue;
+        }
+
+        if (auto top = worldCommands.findTopTile({cell.x, worldTop, cell.z}, chunkSize)) {
+            position.position.y = static_cast<float>(*top + 1);
+        }
+    }
+}
@@ -32,10 +32,9 @@ void systems::transformInstances(engine::Engine& engine, engine::TilePool& tileP
             continue;
         }
 
-        auto& tileInstance = tilePool.getInstance(proxy);
-
-        tileInstance.transform.position = engine::worldToScreenSpace(position.position);
-
-        tileInstance.transform.scale = scale.scale;
+        tilePool.setTransform(proxy, {
+            .position = engine::packTilePosition(position.position),
+            .scale = engine::packTileScale(scale.scale),
+        });
     }
 }